@@ -0,0 +1,95 @@
+/*
+ * zwmstate - print the state exported by zwm in shared memory
+ *
+ * Copyright (c) 2026 cmanv
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Usage: zwmstate [path]
+ * The default path is $XDG_CACHE_HOME/zwm/state-0.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "zwmstate.h"
+
+int
+main(int argc, char **argv)
+{
+	static struct zwm_state state;
+	const struct zwm_state *region;
+	char path[1024];
+	struct stat st;
+	const char *cache;
+	uint32_t i;
+	int fd;
+
+	if (argc > 1) {
+		snprintf(path, sizeof(path), "%s", argv[1]);
+	} else if ((cache = getenv("XDG_CACHE_HOME")) != NULL) {
+		snprintf(path, sizeof(path), "%s/zwm/state-0", cache);
+	} else if ((cache = getenv("HOME")) != NULL) {
+		snprintf(path, sizeof(path), "%s/.cache/zwm/state-0", cache);
+	} else {
+		fprintf(stderr, "zwmstate: HOME is not defined\n");
+		return 1;
+	}
+
+	if ((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+		perror(path);
+		return 1;
+	}
+	if ((size_t)st.st_size < sizeof(state)) {
+		fprintf(stderr, "zwmstate: %s: region too small\n", path);
+		return 1;
+	}
+	region = mmap(NULL, sizeof(state), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (region == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+
+	if (zwm_state_copy(region, &state) < 0) {
+		fprintf(stderr, "zwmstate: %s: no state available\n", path);
+		return 1;
+	}
+
+	printf("screen %d, desktop %d/%u, active window 0x%llx\n",
+	    state.screen, state.active_desktop + 1, state.ndesktops,
+	    (unsigned long long)state.active_window);
+	for (i = 0; i < state.ndesktops; i++) {
+		printf("desktop %u:%s%s%s\n", i + 1,
+		    (state.desktop_flags[i] & ZWM_DESKTOP_ACTIVE) ? " active" : "",
+		    (state.desktop_flags[i] & ZWM_DESKTOP_URGENT) ? " urgent" : "",
+		    (state.desktop_flags[i] & ZWM_DESKTOP_OCCUPIED) ? " occupied" : "");
+	}
+	for (i = 0; i < state.nclients; i++) {
+		const struct zwm_state_client *c = &state.clients[i];
+		printf("0x%08llx desktop %d states 0x%06x %s\n",
+		    (unsigned long long)c->window, c->desktop + 1, c->states,
+		    zwm_state_title(&state, c));
+	}
+	munmap((void *)region, sizeof(state));
+	return 0;
+}
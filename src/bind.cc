@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <X11/XKBlib.h>
 #include <cstdlib>
 #include <iostream>
 #include <string>
@@ -30,6 +31,13 @@
 #include "wmfunc.h"
 #include "bind.h"
 
+namespace bindtable {
+	std::unordered_map<unsigned long, Bind*> keys;
+	std::unordered_map<unsigned long, Bind*> buttons;
+	unsigned long	 unmatched_keys = 0;
+	unsigned long	 unmatched_buttons = 0;
+}
+
 std::vector<ModKeyDef> Bind::modkey_defs = {
 	{ 'S',  ShiftMask },
 	{ 'C',  ControlMask },
@@ -83,33 +91,31 @@ Bind::Bind( BindDef& binddef, long eventtype)
 		}
 	}
 
-	for (wmfunc::FuncDef &funcdef : wmfunc::funcdefs) {
-		if (!funcdef.namefunc.compare(binddef.namefunc)) {
-			function = binddef.namefunc;
-			context = funcdef.context;
-			valid = true;
+	const wmfunc::FuncDef *funcdef = wmfunc::find_function(binddef.namefunc);
+	if (funcdef) {
+		function = binddef.namefunc;
+		context = funcdef->context;
+		valid = true;
 
-			switch (context) {
-			case Context::Root:
-				fscreen = funcdef.fscreen;
-				param = funcdef.param;
-				break;
-			case Context::Window:
-				fclient = funcdef.fclient;
-				param = funcdef.param;
-				break;
-			case Context::FuncCall:
-				fcall = funcdef.fcall;
-				param = funcdef.param;
-				break;
-			case Context::Launcher:
-				flaunch = funcdef.flaunch;
-				path = binddef.path;
-				break;
-			default:
-				valid = false;
-			}
+		switch (context) {
+		case Context::Root:
+			fscreen = funcdef->fscreen;
+			param = funcdef->param;
+			break;
+		case Context::Window:
+			fclient = funcdef->fclient;
+			param = funcdef->param;
 			break;
+		case Context::FuncCall:
+			fcall = funcdef->fcall;
+			param = funcdef->param;
+			break;
+		case Context::Launcher:
+			flaunch = funcdef->flaunch;
+			path = binddef.path;
+			break;
+		default:
+			valid = false;
 		}
 	}
 	if (!valid) {
@@ -121,3 +127,63 @@ Bind::Bind( BindDef& binddef, long eventtype)
 			<< keycombo << "} -> " << function << "(" << path << ")\n";
 	}
 }
+
+// Build the tables from the configured bindings. Keysyms are resolved
+// here so that no keyboard mapping lookup is done when a key is pressed.
+// This must be called again whenever the keyboard mapping changes.
+void bindtable::build()
+{
+	keys.clear();
+	for (Bind &kb : conf::keybindings) {
+		KeyCode kc = XKeysymToKeycode(wm::display, kb.keysym);
+		if (!kc) {
+			std::cerr << timer::gettime() << " [bindtable::" << __func__
+				<< "] Failed converting '" << XKeysymToString(kb.keysym)
+				<< "' keysym to keycode" << std::endl;
+			continue;
+		}
+		unsigned int modmask = kb.modmask;
+		if ((XkbKeycodeToKeysym(wm::display, kc, 0, 0) != kb.keysym) &&
+			(XkbKeycodeToKeysym(wm::display, kc, 0, 1) == kb.keysym))
+			modmask |= ShiftMask;
+		keys.emplace(get_index(kc, modmask), &kb);
+	}
+
+	buttons.clear();
+	for (Bind &mb : conf::mousebindings)
+		buttons.emplace(get_index(mb.button, mb.modmask), &mb);
+
+	if (conf::debug) {
+		std::cout << timer::gettime() << " [bindtable::" << __func__ << "] "
+			<< keys.size() << " keys, " << buttons.size() << " buttons\n";
+	}
+}
+
+// The modifier state must already be cleaned of the ignored modifiers.
+Bind *bindtable::find_key(unsigned int keycode, unsigned int state, bool client)
+{
+	auto it = keys.find(get_index(keycode, state));
+	if ((it == keys.end()) ||
+		(!client && it->second->context == Context::Window)) {
+		unmatched_keys++;
+		return NULL;
+	}
+	return it->second;
+}
+
+Bind *bindtable::find_button(unsigned int button, unsigned int state, bool client)
+{
+	auto it = buttons.find(get_index(button, state));
+	if ((it == buttons.end()) ||
+		(client && it->second->context == Context::Root) ||
+		(!client && it->second->context == Context::Window)) {
+		unmatched_buttons++;
+		return NULL;
+	}
+	return it->second;
+}
+
+unsigned long bindtable::get_index(unsigned int code, unsigned int modmask)
+{
+	return ((unsigned long)code << 16) | (modmask & 0xffff);
+}
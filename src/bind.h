@@ -24,6 +24,7 @@
 #define _BIND_H_
 #include <X11/Xlib.h>
 #include <string>
+#include <unordered_map>
 #include "enums.h"
 
 class XClient;
@@ -69,4 +70,15 @@ struct Bind {
 	static std::vector<ModKeyDef> modkey_defs;
 	Bind(BindDef&, long);
 };
+
+// Bindings indexed by keycode (or button) and modifier mask.
+namespace bindtable {
+	extern std::unordered_map<unsigned long, Bind*>	 keys;
+	extern unsigned long				 unmatched_keys;
+	extern unsigned long				 unmatched_buttons;
+	void		 build();
+	Bind		*find_key(unsigned int, unsigned int, bool);
+	Bind		*find_button(unsigned int, unsigned int, bool);
+	unsigned long	 get_index(unsigned int, unsigned int);
+}
 #endif // BIND_H_
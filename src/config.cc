@@ -134,6 +134,9 @@ namespace conf {
 	std::vector<std::string> colordefs;
 
 	int			debug = 0;
+	bool			state_export = false;
+	bool			layout_on_active = false;
+	bool			drag_outline = false;
 	const int		ndesktops = desktop_defs.size();
 	size_t			tiled_border = 2;
 	size_t			stacked_border = 4;
@@ -261,6 +264,18 @@ void conf::read_config()
 			add_desktop_layouts(layouts);
 			continue;
 		}
+		if (!tokens[0].compare("drag-outline")) {
+			drag_outline = !tokens[1].compare("yes");
+			continue;
+		}
+		if (!tokens[0].compare("layout-viewport")) {
+			layout_on_active = !tokens[1].compare("active");
+			continue;
+		}
+		if (!tokens[0].compare("state-export")) {
+			state_export = !tokens[1].compare("yes");
+			continue;
+		}
 		if (message_socket.empty() && !tokens[0].compare("message-socket")) {
 			message_socket = tokens[1];
 			continue;
@@ -538,6 +553,7 @@ void conf::add_window_states(std::string &rname, std::string &rclass,
 		if (!state.compare("ignored")) statemask |= State::Ignored;
 		if (!state.compare("noborder")) statemask |= State::NoBorder;
 		if (!state.compare("noresize")) statemask |= State::NoResize;
+		if (!state.compare("outline")) statemask |= State::Outline;
 		if (!state.compare("sticky")) statemask |= State::Sticky;
 	}
 
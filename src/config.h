@@ -67,6 +67,9 @@ namespace conf {
 	extern std::string			 user_config;
 	extern std::string			 wmname;
 	extern int				 debug;
+	extern bool				 state_export;
+	extern bool				 layout_on_active;
+	extern bool				 drag_outline;
 	extern size_t				 stacked_border;
 	extern size_t				 tiled_border;
 	extern size_t				 moveamount;
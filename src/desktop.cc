@@ -23,11 +23,11 @@
 #include <X11/Xlib.h>
 #include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include "timer.h"
-#include "socket.h"
+#include "json.h"
+#include "events.h"
 #include "config.h"
 #include "wmcore.h"
 #include "xclient.h"
@@ -92,7 +92,7 @@ void Desktop::rotate_windows(std::vector<XClient*>&clientlist, long direction)
 		}
 		std::rotate(first, second, last);
 	}
-	show(clientlist);
+	m_screen->show_desktop();
 }
 
 void Desktop::cycle_windows(std::vector<XClient*>&clientlist, XClient *client, long direction)
@@ -191,27 +191,39 @@ std::vector<XClient*>::reverse_iterator Desktop::prev_desktop_client(
 void Desktop::show(std::vector<XClient*> &clientlist)
 {
 	restack_windows(clientlist);
-	switch (m_layout)
-	{
-	case Layout::Monocle:
-		tile_maximized(clientlist);
-		break;
-	case Layout::VTiled:
-		tile_vertical(clientlist);
-		break;
-	case Layout::HTiled:
-		tile_horizontal(clientlist);
-		break;
-	case Layout::Grid:
-		tile_grid(clientlist);
-		break;
-	default:
+	if (m_layout & Layout::Tiling) {
+		// Tile on the viewport of the active window, or under the pointer
+		Position p;
+		XClient *active = m_screen->get_active_client();
+		if (conf::layout_on_active && active &&
+		    (active->get_desktop_index() == m_index))
+			p = active->get_geometry().get_center(Coordinates::Root);
+		else
+			p = xpointer::get_pos(m_screen->get_window());
+		Geometry area = m_screen->get_area(p, true);
+		m_tiles.clear();
+		switch (m_layout)
+		{
+		case Layout::Monocle:
+			tile_maximized(clientlist, area);
+			break;
+		case Layout::VTiled:
+			tile_vertical(clientlist, area);
+			break;
+		case Layout::HTiled:
+			tile_horizontal(clientlist, area);
+			break;
+		case Layout::Grid:
+			tile_grid(clientlist, area);
+			break;
+		}
+		apply_tiles(clientlist);
+	} else {
 		stacked_desktop(clientlist);
-		break;
 	}
 
 	for (XClient *client : clientlist)
-		if (client->has_state(State::Sticky)) {
+		if (client->has_state(State::Sticky) && !client->is_mapped()) {
 			client->show_window();
 	}
 
@@ -220,25 +232,29 @@ void Desktop::show(std::vector<XClient*> &clientlist)
 
 void Desktop::panel_update_layout()
 {
-	if (!socket_out::defined()) return;
-	std::stringstream ss;
-	int i = 0;
-	for (auto layout : conf::desktop_layouts) {
-		if (i > 0) ss << ",";
-		ss << "{\"name\":\"" << layout.name << "\",";
-		if (i == m_layout_index) {
-			ss << "\"active\":\"1\"}";
-		} else {
-			ss << "\"active\":\"0\"}";
-		}
-		i++;
-	}
-	std::string message = "{\"layouts\":[" + ss.str() + "]}";
+	if (!events::wanted(TopicLayouts)) return;
+	static std::string message;
+	JsonWriter json(message);
+	json.begin_object().key("layouts");
+	write_layouts(json);
+	json.end_object();
 	if (conf::debug>1) {
 		std::cout << timer::gettime() << " [Desktop::" << __func__ << "]\n";
 		std::cout << "message = [" << message << "]\n";
 	}
-	socket_out::send(message);
+	events::publish(TopicLayouts, message);
+}
+
+void Desktop::write_layouts(JsonWriter &json)
+{
+	json.begin_array();
+	for (size_t i = 0; i < conf::desktop_layouts.size(); i++) {
+		json.begin_object()
+			.key("name").value(conf::desktop_layouts[i].name)
+			.key("active").value(((long)i == m_layout_index) ? "1" : "0")
+			.end_object();
+	}
+	json.end_array();
 }
 
 void Desktop::hide(std::vector<XClient*> &clientlist)
@@ -267,7 +283,9 @@ void Desktop::restack_windows(std::vector<XClient*>&clientlist)
 		if (client->get_desktop_index() == m_index)
 			winlist.push_back(client->get_window());
 	}
+	if (winlist == m_stacking) return;
 	XRestackWindows(wm::display, (Window *)winlist.data(), winlist.size());
+	m_stacking.swap(winlist);
 }
 
 void Desktop::select_layout(std::vector<XClient*> &clientlist, long index)
@@ -290,10 +308,10 @@ void Desktop::select_layout(std::vector<XClient*> &clientlist, long index)
 		}
 	}
 
-	show(clientlist);
+	m_screen->show_desktop();
 }
 
-void Desktop::rotate_layout(std::vector<XClient*> &clientlist, long direction)
+void Desktop::rotate_layout(long direction)
 {
 	m_layout_index += direction;
 	if (m_layout_index == (long)conf::desktop_layouts.size())
@@ -304,10 +322,10 @@ void Desktop::rotate_layout(std::vector<XClient*> &clientlist, long direction)
 	m_layout =  conf::desktop_layouts[m_layout_index].layout;
 	m_cols =  conf::desktop_layouts[m_layout_index].cols;
 	m_rows =  conf::desktop_layouts[m_layout_index].rows;
-	show(clientlist);
+	m_screen->show_desktop();
 }
 
-void Desktop::master_resize(std::vector<XClient*> &clientlist, long increment)
+void Desktop::master_resize(long increment)
 {
 	if (!(m_layout & Layout::MasterSlave)) return;
 	if (increment > 0) {
@@ -317,23 +335,55 @@ void Desktop::master_resize(std::vector<XClient*> &clientlist, long increment)
 		m_master_split -= 0.01;
 		if (m_master_split < 0.1) m_master_split = 0.1;
 	}
-	show(clientlist);
+	m_screen->show_desktop();
 }
 
 void Desktop::stacked_desktop(std::vector<XClient*>&clientlist)
 {
 	for (XClient *client : clientlist) {
 		if (client->get_desktop_index() != m_index) continue;
+		long states = client->get_states();
 		client->clear_states(State::Tiled|State::Frozen|State::Hidden);
 		client->set_stacked_geom();
-		client->show_window();
+		if (!client->is_mapped() || (client->get_states() != states))
+			client->show_window();
 	}
 }
 
-void Desktop::tile_grid(std::vector<XClient*>&clientlist)
+// Configure, map and unmap only the clients whose tile has changed since
+// the last layout.
+void Desktop::apply_tiles(std::vector<XClient*>&clientlist)
+{
+	for (Tile &tile : m_tiles) {
+		XClient *client = tile.client;
+		long states = client->get_states();
+		client->clear_states(tile.clear);
+		client->set_states(tile.set);
+		bool changed = (client->get_states() != states);
+		if (tile.visible) {
+			client->set_tiled_geom(tile.geom);
+			if (tile.master)
+				client->panel_update_title();
+			if (!client->is_mapped() || changed)
+				client->show_window();
+		} else if (client->is_mapped() || !(states & State::Hidden) || changed) {
+			client->hide_window();
+		}
+	}
+
+	for (XClient *client : clientlist) {
+		if (client->get_desktop_index() != m_index) continue;
+		if (client->has_state(State::NoTile)) {
+			if (!client->is_mapped())
+				client->show_window();
+			client->raise_window();
+		}
+	}
+}
+
+// The tile_* functions only compute the tiles of the layout.
+void Desktop::tile_grid(std::vector<XClient*>&clientlist, Geometry &area)
 {
-	Position p = xpointer::get_pos(m_screen->get_window());
-	Geometry area = m_screen->get_area(p, true);
 	int border = conf::tiled_border;
 	int width = area.w / m_cols;
 	int height = area.h / m_rows;
@@ -348,13 +398,11 @@ void Desktop::tile_grid(std::vector<XClient*>&clientlist)
 		if (row < m_rows) {
 			int x = area.x + col * width;
 			int y = area.y + row * height;
-			client->set_states(State::Tiled|State::Frozen);
-			Geometry geom(x, y, w, h);
-			client->set_tiled_geom(geom);
-			client->show_window();
+			m_tiles.push_back(Tile(client, Geometry(x, y, w, h),
+					State::Tiled|State::Frozen, 0, true, false));
 		} else {
-			client->set_states(State::Hidden);
-			client->hide_window();
+			m_tiles.push_back(Tile(client, Geometry(),
+					State::Hidden, 0, false, false));
 		}
 
 		col++;
@@ -363,22 +411,11 @@ void Desktop::tile_grid(std::vector<XClient*>&clientlist)
 			row ++;
 		}
 	}
-
-	for (XClient *client : clientlist) {
-		if (client->get_desktop_index() != m_index) continue;
-		if (client->has_state(State::NoTile)) {
-			client->show_window();
-			client->raise_window();
-		}
-	}
 }
 
-void Desktop::tile_horizontal(std::vector<XClient*>&clientlist)
+void Desktop::tile_horizontal(std::vector<XClient*>&clientlist, Geometry &area)
 {
 	int x, y, w, h;
-
-	Position p = xpointer::get_pos(m_screen->get_window());
-	Geometry area = m_screen->get_area(p, true);
 	int border = conf::tiled_border;
 
 	float mh = area.h;
@@ -400,36 +437,23 @@ void Desktop::tile_horizontal(std::vector<XClient*>&clientlist)
 	for (XClient *client : clientlist) {
 		if (client->get_desktop_index() != m_index) continue;
 		if (client->has_state(State::NoTile)) continue;
-		client->set_states(State::Tiled|State::Frozen);
 		if (master) {
-			client->set_states(State::HMaximized);
-			client->set_tiled_geom(geom_master);
-			client->panel_update_title();
+			m_tiles.push_back(Tile(client, geom_master,
+					State::Tiled|State::Frozen|State::HMaximized,
+					0, true, true));
 			master = false;
 		} else {
-			client->clear_states(State::HMaximized);
 			Geometry slave(x, y, w - 2 * border, h - 2 * border);
-			client->set_tiled_geom(slave);
+			m_tiles.push_back(Tile(client, slave, State::Tiled|State::Frozen,
+					State::HMaximized, true, false));
 			x += w;
 		}
-		client->show_window();
-	}
-
-	for (XClient *client : clientlist) {
-		if (client->get_desktop_index() != m_index) continue;
-		if (client->has_state(State::NoTile)) {
-			client->show_window();
-			client->raise_window();
-		}
 	}
 }
 
-void Desktop::tile_vertical(std::vector<XClient*>&clientlist)
+void Desktop::tile_vertical(std::vector<XClient*>&clientlist, Geometry &area)
 {
 	int x, y, w, h;
-
-Position p = xpointer::get_pos(m_screen->get_window());
-	Geometry area = m_screen->get_area(p, true);
 	int border = conf::tiled_border;
 
 	float mw = area.w;
@@ -451,34 +475,22 @@ Position p = xpointer::get_pos(m_screen->get_window());
 	for (XClient *client : clientlist) {
 		if (client->get_desktop_index() != m_index) continue;
 		if (client->has_state(State::NoTile)) continue;
-		client->set_states(State::Tiled|State::Frozen);
 		if (master) {
-			client->set_states(State::VMaximized);
-			client->set_tiled_geom(geom_master);
-			client->panel_update_title();
+			m_tiles.push_back(Tile(client, geom_master,
+					State::Tiled|State::Frozen|State::VMaximized,
+					0, true, true));
 			master = false;
 		} else {
-			client->clear_states(State::VMaximized);
 			Geometry slave(x, y, w - 2 * border, h - 2 * border);
-			client->set_tiled_geom(slave);
+			m_tiles.push_back(Tile(client, slave, State::Tiled|State::Frozen,
+					State::VMaximized, true, false));
 			y += h;
 		}
-		client->show_window();
-	}
-
-	for (XClient *client : clientlist) {
-		if (client->get_desktop_index() != m_index) continue;
-		if (client->has_state(State::NoTile)) {
-			client->show_window();
-			client->raise_window();
-		}
 	}
 }
 
-void Desktop::tile_maximized(std::vector<XClient*>&clientlist)
+void Desktop::tile_maximized(std::vector<XClient*>&clientlist, Geometry &area)
 {
-	Position p = xpointer::get_pos(m_screen->get_window());
-	Geometry area = m_screen->get_area(p, true);
 	int border = conf::tiled_border;
 
 	bool master = true;
@@ -486,24 +498,14 @@ void Desktop::tile_maximized(std::vector<XClient*>&clientlist)
 	for (XClient *client : clientlist) {
 		if (client->get_desktop_index() != m_index) continue;
 		if (client->has_state(State::NoTile)) continue;
-		client->set_states(State::Tiled|State::Maximized|State::Frozen);
+		long states = State::Tiled|State::Maximized|State::Frozen;
 		if (master) {
-			client->clear_states(State::Hidden);
-			client->set_tiled_geom(maximized);
-			client->show_window();
-			client->panel_update_title();
+			m_tiles.push_back(Tile(client, maximized, states,
+					State::Hidden, true, true));
 			master = false;
 		} else {
-			client->set_states(State::Hidden);
-			client->hide_window();
-		}
-	}
-
-	for (XClient *client : clientlist) {
-		if (client->get_desktop_index() != m_index) continue;
-		if (client->has_state(State::NoTile)) {
-			client->show_window();
-			client->raise_window();
+			m_tiles.push_back(Tile(client, Geometry(),
+					states|State::Hidden, 0, false, false));
 		}
 	}
 }
@@ -24,11 +24,26 @@
 #define _DESKTOP_H_
 #include <string>
 #include <vector>
+#include <X11/Xlib.h>
 #include "enums.h"
+#include "geometry.h"
 
+class JsonWriter;
 class XClient;
 class XScreen;
 
+// Target state of a tiled client computed by a layout
+struct Tile {
+	XClient		*client;
+	Geometry	 geom;
+	long		 set;		// states to set
+	long		 clear;		// states to clear
+	bool		 visible;
+	bool		 master;
+	Tile(XClient *c, Geometry g, long s, long cl, bool v, bool m):
+		client(c), geom(g), set(s), clear(cl), visible(v), master(m) {}
+};
+
 class Desktop {
 	std::string		 m_name;
 	XScreen			*m_screen;
@@ -38,25 +53,31 @@ class Desktop {
 	float			 m_master_split;
 	long			 m_cols;
 	long			 m_rows;
+	std::vector<Tile>	 m_tiles;
+	std::vector<Window>	 m_stacking;
 public:
 	Desktop(std::string&, XScreen *, long, std::string&, float);
 	std::string		&get_name() { return m_name; }
+	long			 get_layout_index() const { return m_layout_index; }
+	float			 get_master_split() const { return m_master_split; }
 	void			 rotate_windows(std::vector<XClient*>&, long);
 	void 			 cycle_windows(std::vector<XClient*>&, XClient *, long);
 	void 			 swap_windows(std::vector<XClient*>&, XClient *, long);
-	void			 master_resize(std::vector<XClient*>&, long);
+	void			 master_resize(long);
 	void			 show(std::vector<XClient*>&);
 	void			 hide(std::vector<XClient*>&);
 	void			 close(std::vector<XClient*>&);
 	void			 select_layout(std::vector<XClient*>&, long);
-	void			 rotate_layout(std::vector<XClient*>&, long);
+	void			 rotate_layout(long);
 	void			 panel_update_layout();
+	void			 write_layouts(JsonWriter&);
 private:
 	void			 restack_windows(std::vector<XClient*>&);
-	void 			 tile_grid(std::vector<XClient*>&);
-	void 			 tile_horizontal(std::vector<XClient*>&);
-	void 			 tile_vertical(std::vector<XClient*>&);
-	void 			 tile_maximized(std::vector<XClient*>&);
+	void 			 tile_grid(std::vector<XClient*>&, Geometry&);
+	void 			 tile_horizontal(std::vector<XClient*>&, Geometry&);
+	void 			 tile_vertical(std::vector<XClient*>&, Geometry&);
+	void 			 tile_maximized(std::vector<XClient*>&, Geometry&);
+	void 			 apply_tiles(std::vector<XClient*>&);
 	void 			 stacked_desktop(std::vector<XClient*>&);
 	std::vector<XClient*>::iterator next_desktop_client(std::vector<XClient*>&,
 								XClient *);
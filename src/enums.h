@@ -39,6 +39,8 @@ enum _ewmhints {
 	_NET_WM_NAME,
 	_NET_WM_DESKTOP,
 	_NET_CLOSE_WINDOW,
+	_NET_WM_SYNC_REQUEST,
+	_NET_WM_SYNC_REQUEST_COUNTER,
 	_NET_WM_WINDOW_TYPE,
 	_NET_WM_WINDOW_TYPE_DIALOG,
 	_NET_WM_WINDOW_TYPE_DOCK,
@@ -90,8 +92,10 @@ enum State {
 	NoTile		= 0x001000,
 	NoResize	= 0x002000,
 	NoBorder	= 0x004000,
+	Outline		= 0x008000,
 	WMDeleteWindow	= 0x010000,
 	WMTakeFocus	= 0x020000,
+	WMSyncRequest	= 0x040000,
 	Maximized	= HMaximized|VMaximized,
 	Ignored		= SkipPager|SkipTaskbar,
 	SkipCycle	= Hidden|Ignored,
@@ -165,11 +169,41 @@ enum Direction {
 	SouthEast	= South|East,
 };
 
+// Operations on a window dragged with the pointer
+enum DragMode {
+	DragMove,
+	DragResize
+};
+
 enum EventType {
 	Key,
 	Button
 };
 
+enum IoFilter {
+	IoRead		= 0x01,
+	IoWrite		= 0x02,
+};
+
+// Actions on a new or activated client, done after the desktop layout
+enum PendingAction {
+	PendingWarp	= 0x01,
+	PendingRaise	= 0x02,
+	PendingActivate	= 0x04,
+};
+
+// Kinds of messages sent to the panel and to subscribers
+enum Topic {
+	TopicFocus	= 0x01,
+	TopicTitle	= 0x02,
+	TopicDesktops	= 0x04,
+	TopicLayouts	= 0x08,
+	TopicClients	= 0x10,
+	TopicGeometry	= 0x20,
+	TopicPanel	= TopicFocus|TopicTitle|TopicDesktops|TopicLayouts|TopicClients,
+	TopicAll	= TopicPanel|TopicGeometry,
+};
+
 enum class Coordinates {
 	Root,
 	Window,
@@ -0,0 +1,95 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string>
+#include <string_view>
+#include "enums.h"
+#include "socket.h"
+#include "events.h"
+
+namespace events {
+	struct TopicName {
+		long		 topic;
+		const char	*name;
+	};
+
+	const TopicName topicnames[] = {
+		{ TopicFocus, "focus" },
+		{ TopicTitle, "title" },
+		{ TopicDesktops, "desktops" },
+		{ TopicLayouts, "layouts" },
+		{ TopicClients, "clients" },
+		{ TopicGeometry, "geometry" },
+		{ TopicAll, "all" },
+	};
+
+	SnapshotHandler	 snapshot = NULL;
+}
+
+void events::init(SnapshotHandler h)
+{
+	snapshot = h;
+}
+
+// Whether a message of this topic would be delivered to anyone. Messages
+// are not built otherwise.
+bool events::wanted(long topic)
+{
+	return ((topic & TopicPanel) && socket_out::active()) ||
+		socket_in::subscribed(topic);
+}
+
+void events::publish(long topic, const std::string &message)
+{
+	if (topic & TopicPanel)
+		socket_out::send(message);
+	socket_in::publish(topic, message);
+}
+
+// Snapshot of the state, one message per line
+void events::get_snapshot(std::string &messages)
+{
+	messages.clear();
+	if (snapshot) (*snapshot)(messages);
+}
+
+// Parse a comma separated list of topics. Return -1 if one is unknown.
+long events::get_topics(std::string_view list)
+{
+	long topics = 0;
+	while (!list.empty()) {
+		size_t pos = list.find(',');
+		std::string_view name = list.substr(0, pos);
+		list = (pos == std::string_view::npos) ? "" : list.substr(pos + 1);
+		if (name.empty()) continue;
+		long topic = -1;
+		for (const TopicName &t : topicnames) {
+			if (name == t.name) {
+				topic = t.topic;
+				break;
+			}
+		}
+		if (topic == -1) return -1;
+		topics |= topic;
+	}
+	return topics;
+}
@@ -0,0 +1,39 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _EVENTS_H_
+#define _EVENTS_H_
+#include <string>
+#include <string_view>
+
+typedef void (*SnapshotHandler)(std::string&);
+
+// Messages describing changes of state are published once and delivered
+// to the panel and to the subscribers of their topic.
+namespace events {
+	void	 init(SnapshotHandler);
+	bool	 wanted(long);
+	void	 publish(long, const std::string&);
+	void	 get_snapshot(std::string&);
+	long	 get_topics(std::string_view);
+}
+#endif /* _EVENTS_H_ */
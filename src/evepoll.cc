@@ -0,0 +1,170 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "evloop.h"
+
+// Linux backend: epoll for descriptors, timerfd for scheduled
+// work and signalfd for signals.
+class EpollBackend: public EvBackend {
+	int			 m_epfd;
+	int			 m_timerfd;
+	int			 m_sigfd;
+	sigset_t		 m_sigmask;
+	std::vector<epoll_event> m_events;
+public:
+	EpollBackend(int, int);
+	~EpollBackend();
+	const char		*name() const { return "epoll"; }
+	bool			 add(int, long);
+	bool			 modify(int, long);
+	void			 remove(int);
+	bool			 add_signal(int);
+	void			 set_timer(long);
+	int			 wait(std::vector<IoReady>&, std::vector<int>&, bool&);
+private:
+	static uint32_t		 get_mask(long);
+};
+
+EvBackend *evloop::create_backend()
+{
+	int epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (epfd == -1) return NULL;
+
+	int timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+	if (timerfd == -1) {
+		close(epfd);
+		return NULL;
+	}
+	return new EpollBackend(epfd, timerfd);
+}
+
+EpollBackend::EpollBackend(int epfd, int timerfd)
+	: m_epfd(epfd), m_timerfd(timerfd), m_sigfd(-1), m_events(32)
+{
+	sigemptyset(&m_sigmask);
+	add(m_timerfd, IoFilter::IoRead);
+}
+
+EpollBackend::~EpollBackend()
+{
+	sigprocmask(SIG_UNBLOCK, &m_sigmask, NULL);
+	if (m_sigfd != -1) close(m_sigfd);
+	close(m_timerfd);
+	close(m_epfd);
+}
+
+uint32_t EpollBackend::get_mask(long filter)
+{
+	uint32_t mask = 0;
+	if (filter & IoFilter::IoRead) mask |= EPOLLIN;
+	if (filter & IoFilter::IoWrite) mask |= EPOLLOUT;
+	return mask;
+}
+
+bool EpollBackend::add(int fd, long filter)
+{
+	epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = get_mask(filter);
+	ev.data.fd = fd;
+	return (epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev) == 0);
+}
+
+bool EpollBackend::modify(int fd, long filter)
+{
+	epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = get_mask(filter);
+	ev.data.fd = fd;
+	return (epoll_ctl(m_epfd, EPOLL_CTL_MOD, fd, &ev) == 0);
+}
+
+void EpollBackend::remove(int fd)
+{
+	epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+// Signals must be blocked to be received through the signalfd.
+bool EpollBackend::add_signal(int sig)
+{
+	sigaddset(&m_sigmask, sig);
+	if (sigprocmask(SIG_BLOCK, &m_sigmask, NULL) == -1)
+		return false;
+
+	int fd = signalfd(m_sigfd, &m_sigmask, SFD_NONBLOCK|SFD_CLOEXEC);
+	if (fd == -1) return false;
+	if (m_sigfd == -1) {
+		m_sigfd = fd;
+		return add(m_sigfd, IoFilter::IoRead);
+	}
+	return true;
+}
+
+// One shot timer. A negative value disarms it.
+void EpollBackend::set_timer(long msec)
+{
+	itimerspec its;
+	memset(&its, 0, sizeof(its));
+	if (msec >= 0) {
+		its.it_value.tv_sec = msec / 1000;
+		its.it_value.tv_nsec = (msec % 1000) * 1000000;
+		// A zero value would disarm the timer
+		if (!msec) its.it_value.tv_nsec = 1;
+	}
+	timerfd_settime(m_timerfd, 0, &its, NULL);
+}
+
+int EpollBackend::wait(std::vector<IoReady> &ready, std::vector<int> &signals,
+			bool &expired)
+{
+	int nev = epoll_wait(m_epfd, m_events.data(), m_events.size(), -1);
+	for (int i = 0; i < nev; i++) {
+		epoll_event &ev = m_events[i];
+		if (ev.data.fd == m_timerfd) {
+			uint64_t count;
+			while (read(m_timerfd, &count, sizeof(count)) > 0)
+				expired = true;
+		} else if (ev.data.fd == m_sigfd) {
+			signalfd_siginfo info;
+			while (read(m_sigfd, &info, sizeof(info)) == sizeof(info))
+				signals.push_back(info.ssi_signo);
+		} else {
+			long filter = 0;
+			if (ev.events & (EPOLLIN|EPOLLHUP|EPOLLERR))
+				filter |= IoFilter::IoRead;
+			if (ev.events & EPOLLOUT)
+				filter |= IoFilter::IoWrite;
+			ready.push_back(IoReady(ev.data.fd, filter));
+		}
+	}
+	return nev;
+}
+#endif // USE_EPOLL
@@ -0,0 +1,129 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifdef USE_KQUEUE
+#include <sys/event.h>
+#include <unistd.h>
+#include <csignal>
+#include <vector>
+#include "evloop.h"
+
+// BSD backend: kqueue with EVFILT_TIMER and EVFILT_SIGNAL.
+class KqueueBackend: public EvBackend {
+	int			 m_kq;
+	std::vector<struct kevent> m_events;
+	static const int	 TimerIdent;
+public:
+	KqueueBackend(int kq): m_kq(kq), m_events(32) {}
+	~KqueueBackend() { close(m_kq); }
+	const char		*name() const { return "kqueue"; }
+	bool			 add(int, long);
+	bool			 modify(int, long);
+	void			 remove(int);
+	bool			 add_signal(int);
+	void			 set_timer(long);
+	int			 wait(std::vector<IoReady>&, std::vector<int>&, bool&);
+private:
+	static void		 null_handler(int) {}
+};
+
+const int KqueueBackend::TimerIdent = 1;
+
+EvBackend *evloop::create_backend()
+{
+	int kq = kqueue();
+	if (kq == -1) return NULL;
+	return new KqueueBackend(kq);
+}
+
+bool KqueueBackend::add(int fd, long filter)
+{
+	struct kevent watch[2];
+	EV_SET(&watch[0], fd, EVFILT_READ,
+		EV_ADD|((filter & IoFilter::IoRead) ? EV_ENABLE : EV_DISABLE), 0, 0, 0);
+	EV_SET(&watch[1], fd, EVFILT_WRITE,
+		EV_ADD|((filter & IoFilter::IoWrite) ? EV_ENABLE : EV_DISABLE), 0, 0, 0);
+	return (kevent(m_kq, watch, 2, NULL, 0, NULL) != -1);
+}
+
+bool KqueueBackend::modify(int fd, long filter)
+{
+	return add(fd, filter);
+}
+
+void KqueueBackend::remove(int fd)
+{
+	struct kevent watch;
+	EV_SET(&watch, fd, EVFILT_READ, EV_DELETE, 0, 0, 0);
+	kevent(m_kq, &watch, 1, NULL, 0, NULL);
+	EV_SET(&watch, fd, EVFILT_WRITE, EV_DELETE, 0, 0, 0);
+	kevent(m_kq, &watch, 1, NULL, 0, NULL);
+}
+
+// kqueue records the signal even when it is not delivered:
+// the disposition is set to a no-op handler so that the default
+// action is not taken.
+bool KqueueBackend::add_signal(int sig)
+{
+	if (signal(sig, null_handler) == SIG_ERR)
+		return false;
+
+	struct kevent watch;
+	EV_SET(&watch, sig, EVFILT_SIGNAL, EV_ADD, 0, 0, 0);
+	return (kevent(m_kq, &watch, 1, NULL, 0, NULL) != -1);
+}
+
+// One shot timer. A negative value disarms it.
+void KqueueBackend::set_timer(long msec)
+{
+	struct kevent watch;
+	if (msec < 0)
+		EV_SET(&watch, TimerIdent, EVFILT_TIMER, EV_DELETE, 0, 0, 0);
+	else
+		EV_SET(&watch, TimerIdent, EVFILT_TIMER, EV_ADD|EV_ONESHOT, 0, msec, 0);
+	kevent(m_kq, &watch, 1, NULL, 0, NULL);
+}
+
+int KqueueBackend::wait(std::vector<IoReady> &ready, std::vector<int> &signals,
+			bool &expired)
+{
+	int nev = kevent(m_kq, NULL, 0, m_events.data(), m_events.size(), NULL);
+	for (int i = 0; i < nev; i++) {
+		struct kevent &ev = m_events[i];
+		switch (ev.filter) {
+		case EVFILT_READ:
+			ready.push_back(IoReady(ev.ident, IoFilter::IoRead));
+			break;
+		case EVFILT_WRITE:
+			ready.push_back(IoReady(ev.ident, IoFilter::IoWrite));
+			break;
+		case EVFILT_SIGNAL:
+			signals.push_back(ev.ident);
+			break;
+		case EVFILT_TIMER:
+			expired = true;
+			break;
+		}
+	}
+	return nev;
+}
+#endif // USE_KQUEUE
@@ -0,0 +1,246 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+#include "timer.h"
+#include "config.h"
+#include "evloop.h"
+
+namespace evloop {
+	typedef std::chrono::steady_clock clock;
+
+	struct Timer {
+		clock::time_point	 deadline;
+		TimerHandler		 handler;
+		Timer(clock::time_point d, TimerHandler h): deadline(d), handler(h) {}
+	};
+
+	EvBackend			*backend = NULL;
+	std::map<int, IoHandler>	 watchers;
+	std::map<int, SignalHandler>	 sighandlers;
+	std::vector<Timer>		 timers;
+	std::vector<IoReady>		 ready;
+	std::vector<int>		 caught;
+	Stats				 stats;
+
+	static void	 arm_timer();
+	static void	 run_timers(clock::time_point);
+	static long	 usec_between(clock::time_point, clock::time_point);
+}
+
+void evloop::init()
+{
+	if (backend) return;
+	backend = create_backend();
+	if (!backend) {
+		std::cerr << " [evloop::" << __func__ << "] "
+			<< std::strerror(errno) << std::endl;
+		exit(1);
+	}
+	memset(&stats, 0, sizeof(stats));
+	if (conf::debug) {
+		std::cout << timer::gettime() << " [evloop::" << __func__
+			<< "] Using " << backend->name() << " backend\n";
+	}
+}
+
+void evloop::clear()
+{
+	delete backend;
+	backend = NULL;
+	watchers.clear();
+	sighandlers.clear();
+	timers.clear();
+}
+
+const char *evloop::backend_name()
+{
+	return backend ? backend->name() : "none";
+}
+
+bool evloop::watch(int fd, long filter, IoHandler handler)
+{
+	if (!backend->add(fd, filter)) {
+		std::cerr << " [evloop::" << __func__ << "] fd " << fd << ": "
+			<< std::strerror(errno) << std::endl;
+		return false;
+	}
+	watchers[fd] = handler;
+	return true;
+}
+
+void evloop::modify(int fd, long filter)
+{
+	if (watchers.find(fd) == watchers.end()) return;
+	backend->modify(fd, filter);
+}
+
+void evloop::unwatch(int fd)
+{
+	if (watchers.erase(fd))
+		backend->remove(fd);
+}
+
+// The signal is no longer delivered asynchronously: the handler
+// is called from the event loop like any other event source.
+bool evloop::watch_signal(int sig, SignalHandler handler)
+{
+	if (!backend->add_signal(sig)) {
+		std::cerr << " [evloop::" << __func__ << "] signal " << sig << ": "
+			<< std::strerror(errno) << std::endl;
+		return false;
+	}
+	sighandlers[sig] = handler;
+	return true;
+}
+
+// Call handler once after msec milliseconds. A pending timer
+// with the same handler is rescheduled.
+void evloop::schedule(long msec, TimerHandler handler)
+{
+	clock::time_point deadline = clock::now() + std::chrono::milliseconds(msec);
+	for (Timer &t : timers) {
+		if (t.handler == handler) {
+			t.deadline = deadline;
+			arm_timer();
+			return;
+		}
+	}
+	timers.push_back(Timer(deadline, handler));
+	arm_timer();
+}
+
+void evloop::cancel(TimerHandler handler)
+{
+	for (auto it = timers.begin(); it != timers.end(); it++) {
+		if (it->handler == handler) {
+			timers.erase(it);
+			arm_timer();
+			return;
+		}
+	}
+}
+
+// Wait for the next batch of events and run their handlers.
+void evloop::dispatch()
+{
+	bool expired = false;
+	ready.clear();
+	caught.clear();
+
+	if (backend->wait(ready, caught, expired) == -1) {
+		if (errno != EINTR) {
+			std::cerr << " [evloop::" << __func__ << "] " << backend->name()
+				<< ": " << std::strerror(errno) << std::endl;
+		}
+		return;
+	}
+	clock::time_point start = clock::now();
+	stats.wakeups++;
+
+	for (int sig : caught) {
+		stats.signals++;
+		auto it = sighandlers.find(sig);
+		if (it != sighandlers.end())
+			(*it->second)(sig);
+	}
+
+	for (IoReady &r : ready) {
+		// A previous handler may have closed this descriptor
+		auto it = watchers.find(r.fd);
+		if (it == watchers.end()) continue;
+		stats.io_events++;
+		(*it->second)(r.fd, r.filter);
+	}
+
+	if (expired) run_timers(start);
+
+	long busy = usec_between(start, clock::now());
+	stats.busy_usec += busy;
+	if (busy > stats.busy_max_usec) stats.busy_max_usec = busy;
+}
+
+const evloop::Stats &evloop::get_stats()
+{
+	return stats;
+}
+
+void evloop::print_stats()
+{
+	long avg = stats.wakeups ? stats.busy_usec / (long)stats.wakeups : 0;
+	long late = stats.timers ? stats.timer_late_usec / (long)stats.timers : 0;
+	std::cout << timer::gettime() << " [evloop::" << __func__ << "] "
+		<< backend_name() << ": " << std::dec << stats.wakeups << " wakeups, "
+		<< stats.io_events << " io events, " << stats.signals << " signals, "
+		<< stats.timers << " timers\n";
+	std::cout << timer::gettime() << " [evloop::" << __func__ << "] "
+		<< "busy avg " << avg << "us max " << stats.busy_max_usec << "us, "
+		<< "timer latency avg " << late << "us max "
+		<< stats.timer_late_max_usec << "us\n";
+}
+
+// Arm the backend timer for the earliest deadline.
+static void evloop::arm_timer()
+{
+	if (timers.empty()) {
+		backend->set_timer(-1);
+		return;
+	}
+	clock::time_point next = timers.front().deadline;
+	for (Timer &t : timers)
+		if (t.deadline < next) next = t.deadline;
+
+	long usec = usec_between(clock::now(), next);
+	backend->set_timer(usec > 0 ? (usec + 999) / 1000 : 0);
+}
+
+static void evloop::run_timers(clock::time_point now)
+{
+	// Handlers may schedule new timers: collect the expired ones first.
+	std::vector<Timer> expired;
+	for (auto it = timers.begin(); it != timers.end(); ) {
+		if (it->deadline <= now) {
+			expired.push_back(*it);
+			it = timers.erase(it);
+		} else
+			it++;
+	}
+
+	for (Timer &t : expired) {
+		long late = usec_between(t.deadline, now);
+		stats.timers++;
+		stats.timer_late_usec += late;
+		if (late > stats.timer_late_max_usec) stats.timer_late_max_usec = late;
+		(*t.handler)();
+	}
+	arm_timer();
+}
+
+static long evloop::usec_between(clock::time_point from, clock::time_point to)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
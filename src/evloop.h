@@ -0,0 +1,76 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _EVLOOP_H_
+#define _EVLOOP_H_
+#include <vector>
+#include "enums.h"
+
+typedef void (*IoHandler)(int, long);
+typedef void (*SignalHandler)(int);
+typedef void (*TimerHandler)(void);
+
+struct IoReady {
+	int		 fd;
+	long		 filter;
+	IoReady(int f, long m): fd(f), filter(m) {}
+};
+
+// Interface implemented by the platform event notification backends.
+class EvBackend {
+public:
+	virtual ~EvBackend() {}
+	virtual const char	*name() const = 0;
+	virtual bool		 add(int, long) = 0;
+	virtual bool		 modify(int, long) = 0;
+	virtual void		 remove(int) = 0;
+	virtual bool		 add_signal(int) = 0;
+	virtual void		 set_timer(long) = 0;
+	virtual int		 wait(std::vector<IoReady>&, std::vector<int>&, bool&) = 0;
+};
+
+namespace evloop {
+	struct Stats {
+		unsigned long	 wakeups;
+		unsigned long	 io_events;
+		unsigned long	 signals;
+		unsigned long	 timers;
+		long		 busy_usec;
+		long		 busy_max_usec;
+		long		 timer_late_usec;
+		long		 timer_late_max_usec;
+	};
+	EvBackend	*create_backend();
+	void		 init();
+	void		 clear();
+	const char	*backend_name();
+	bool		 watch(int, long, IoHandler);
+	void		 modify(int, long);
+	void		 unwatch(int);
+	bool		 watch_signal(int, SignalHandler);
+	void		 schedule(long, TimerHandler);
+	void		 cancel(TimerHandler);
+	void		 dispatch();
+	const Stats	&get_stats();
+	void		 print_stats();
+}
+#endif // _EVLOOP_H_
@@ -337,6 +337,7 @@ Viewport::Viewport(int id, int x, int y, int w, int h, BorderGap &b)
 	view.h = h;
 	work = view;
 	work.apply_border_gap(b);
+	rate = 0;
 }
 
 Viewport::Viewport(int id, Geometry &g, BorderGap &b)
@@ -345,6 +346,7 @@ Viewport::Viewport(int id, Geometry &g, BorderGap &b)
 	view = g;
 	work = g;
 	work.apply_border_gap(b);
+	rate = 0;
 }
 
 bool Viewport::contains(Position p)
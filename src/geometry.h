@@ -71,6 +71,9 @@ struct Geometry {
 	Geometry() { x=0; y=0; w=0; h=0; }
 	Geometry(int px, int py, int pw, int ph):
 		x(px), y(py), w(pw), h(ph) {}
+	bool 	operator==(const Geometry &g) const {
+		return ((x == g.x) && (y == g.y) && (w == g.w) && (h == g.h)); }
+	bool 	operator!=(const Geometry &g) const { return !(*this == g); }
 	Position	get_center(Coordinates);
 	bool	 	contains(Position, Coordinates);
 	bool	 	intersects(Geometry &, int);
@@ -91,11 +94,15 @@ class Viewport {
 	int		num;
 	Geometry 	view;
 	Geometry 	work;
+	double		rate;	// refresh rate in Hz, 0 if unknown
 public:
 	Viewport(int id, int x, int y, int w, int h, BorderGap&);
 	Viewport(int id, Geometry&, BorderGap&);
 	int		get_num() const { return num; }
+	double		get_rate() const { return rate; }
+	void		set_rate(double r) { rate = r; }
 	Geometry	get_view() const { return view; }
+	Geometry	get_work() const { return work; }
 	bool 		contains(Position);
 };
 
@@ -0,0 +1,198 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "json.h"
+
+// Append a JSON string literal. Control characters are escaped and
+// invalid UTF-8 sequences are replaced by U+FFFD.
+void json::escape(std::string &out, std::string_view str)
+{
+	static const char hex[] = "0123456789abcdef";
+	out.push_back('"');
+	size_t i = 0, n = str.length();
+	while (i < n) {
+		unsigned char c = str[i];
+		if (c < 0x80) {
+			switch (c) {
+			case '"': out.append("\\\""); break;
+			case '\\': out.append("\\\\"); break;
+			case '\b': out.append("\\b"); break;
+			case '\f': out.append("\\f"); break;
+			case '\n': out.append("\\n"); break;
+			case '\r': out.append("\\r"); break;
+			case '\t': out.append("\\t"); break;
+			default:
+				if (c < 0x20) {
+					out.append("\\u00");
+					out.push_back(hex[c >> 4]);
+					out.push_back(hex[c & 0xf]);
+				} else
+					out.push_back(c);
+			}
+			i++;
+			continue;
+		}
+
+		// Length and minimum code point of the multibyte sequence
+		size_t len = 0;
+		unsigned long cp = 0, min = 0;
+		if ((c & 0xe0) == 0xc0) {
+			len = 2; cp = c & 0x1f; min = 0x80;
+		} else if ((c & 0xf0) == 0xe0) {
+			len = 3; cp = c & 0x0f; min = 0x800;
+		} else if ((c & 0xf8) == 0xf0) {
+			len = 4; cp = c & 0x07; min = 0x10000;
+		}
+		size_t j = 1;
+		for (; len && (j < len) && (i + j < n); j++) {
+			unsigned char cc = str[i+j];
+			if ((cc & 0xc0) != 0x80) break;
+			cp = (cp << 6) | (cc & 0x3f);
+		}
+		if (!len || (j < len) || (cp < min) || (cp > 0x10ffff) ||
+			((cp >= 0xd800) && (cp <= 0xdfff))) {
+			out.append("\xef\xbf\xbd");
+			i += j;
+			continue;
+		}
+		out.append(str.data() + i, len);
+		i += len;
+	}
+	out.push_back('"');
+}
+
+JsonWriter::JsonWriter(std::string &out): m_out(out)
+{
+	m_out.clear();
+	m_depth = 0;
+	m_first[0] = true;
+	m_after_key = false;
+}
+
+void JsonWriter::separator()
+{
+	if (m_after_key) {
+		m_after_key = false;
+		return;
+	}
+	if (!m_first[m_depth])
+		m_out.push_back(',');
+	m_first[m_depth] = false;
+}
+
+void JsonWriter::open(char c)
+{
+	separator();
+	m_out.push_back(c);
+	if (m_depth < MaxDepth - 1) m_depth++;
+	m_first[m_depth] = true;
+}
+
+void JsonWriter::close(char c)
+{
+	m_out.push_back(c);
+	if (m_depth > 0) m_depth--;
+}
+
+JsonWriter &JsonWriter::key(std::string_view k)
+{
+	separator();
+	json::escape(m_out, k);
+	m_out.push_back(':');
+	m_after_key = true;
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(std::string_view v)
+{
+	separator();
+	json::escape(m_out, v);
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(long v)
+{
+	char buf[24];
+	separator();
+	auto res = std::to_chars(buf, buf + sizeof(buf), v);
+	m_out.append(buf, res.ptr - buf);
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(unsigned long v)
+{
+	char buf[24];
+	separator();
+	auto res = std::to_chars(buf, buf + sizeof(buf), v);
+	m_out.append(buf, res.ptr - buf);
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(double v)
+{
+	char buf[32];
+	separator();
+	int n = snprintf(buf, sizeof(buf), "%.6g", v);
+	m_out.append(buf, n);
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(bool v)
+{
+	separator();
+	m_out.append(v ? "true" : "false");
+	return *this;
+}
+
+JsonWriter &JsonWriter::null()
+{
+	separator();
+	m_out.append("null");
+	return *this;
+}
+
+// Number written as a string, as in the panel messages
+JsonWriter &JsonWriter::quoted(long v)
+{
+	char buf[24];
+	separator();
+	auto res = std::to_chars(buf, buf + sizeof(buf), v);
+	m_out.push_back('"');
+	m_out.append(buf, res.ptr - buf);
+	m_out.push_back('"');
+	return *this;
+}
+
+JsonWriter &JsonWriter::quoted(unsigned long v)
+{
+	char buf[24];
+	separator();
+	auto res = std::to_chars(buf, buf + sizeof(buf), v);
+	m_out.push_back('"');
+	m_out.append(buf, res.ptr - buf);
+	m_out.push_back('"');
+	return *this;
+}
@@ -0,0 +1,62 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _JSON_H_
+#define _JSON_H_
+#include <string>
+#include <string_view>
+
+namespace json {
+	void escape(std::string&, std::string_view);
+}
+
+// Streaming JSON writer. The document is appended to a string owned by
+// the caller, which can be reused from one message to the next.
+class JsonWriter {
+	static const int	 MaxDepth = 16;
+	std::string		&m_out;
+	int			 m_depth;
+	bool			 m_first[MaxDepth];
+	bool			 m_after_key;
+	void			 separator();
+	void			 open(char);
+	void			 close(char);
+public:
+	JsonWriter(std::string &);
+	JsonWriter		&begin_object() { open('{'); return *this; }
+	JsonWriter		&end_object() { close('}'); return *this; }
+	JsonWriter		&begin_array() { open('['); return *this; }
+	JsonWriter		&end_array() { close(']'); return *this; }
+	JsonWriter		&key(std::string_view);
+	JsonWriter		&value(std::string_view);
+	JsonWriter		&value(const char *s) { return value(std::string_view(s)); }
+	JsonWriter		&value(int v) { return value((long)v); }
+	JsonWriter		&value(long);
+	JsonWriter		&value(unsigned long);
+	JsonWriter		&value(double);
+	JsonWriter		&value(bool);
+	JsonWriter		&null();
+	JsonWriter		&quoted(int v) { return quoted((long)v); }
+	JsonWriter		&quoted(long);
+	JsonWriter		&quoted(unsigned long);
+};
+#endif /* _JSON_H_ */
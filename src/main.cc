@@ -29,6 +29,7 @@
 #include <string>
 #include "version.h"
 #include "config.h"
+#include "evloop.h"
 #include "wmcore.h"
 
 static std::string appname(PROJECT_NAME);
@@ -74,18 +75,18 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if (signal(SIGCHLD, signal_handler) == SIG_ERR ||
-	    signal(SIGHUP, signal_handler) == SIG_ERR ||
-	    signal(SIGINT, signal_handler) == SIG_ERR ||
-	    signal(SIGTERM, signal_handler) == SIG_ERR) {
-		std::cerr << "signal: " << std::strerror(errno) << std::endl;
-		return 1;
-	}
-
 	conf::init();
 	if (parse_only)
 		return 0;
 
+	// Signals are handled from the event loop
+	evloop::init();
+	if (!evloop::watch_signal(SIGCHLD, signal_handler) ||
+	    !evloop::watch_signal(SIGHUP, signal_handler) ||
+	    !evloop::watch_signal(SIGINT, signal_handler) ||
+	    !evloop::watch_signal(SIGTERM, signal_handler))
+		return 1;
+
 	wm::run();
 	return 0;
 }
@@ -93,7 +94,7 @@ int main(int argc, char **argv)
 static void signal_handler(int sig)
 {
 	pid_t	 pid;
-	int	 save_errno = errno, status;
+	int	 status;
 
 	switch (sig) {
 	case SIGCHLD:
@@ -110,8 +111,6 @@ static void signal_handler(int sig)
 		wm::status = IsQuitting;
 		break;
 	}
-
-	errno = save_errno;
 }
 
 static void show_version(void)
@@ -22,6 +22,7 @@
 
 #include <sys/wait.h>
 #include <unistd.h>
+#include <csignal>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -82,7 +83,10 @@ static void process::execute(std::string &path)
 		argv[n++] = (char *)s.c_str();
 	argv[n] = NULL;
 
-	// Execute the command
+	// Execute the command with the signals blocked by the event loop restored
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigprocmask(SIG_SETMASK, &mask, NULL);
 	setsid();
 	execvp((char *)argv[0], (char **)argv.data());
 	std::cerr << "Error exec: " << path << std::endl;
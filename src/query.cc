@@ -0,0 +1,240 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <X11/Xlib.h>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "desktop.h"
+#include "json.h"
+#include "socket.h"
+#include "xclient.h"
+#include "xscreen.h"
+#include "query.h"
+
+namespace query {
+	struct QueryDef {
+		const char	*name;
+		const char	*(*fquery)(XScreen *, const long *, JsonWriter&);
+	};
+
+	struct StateName {
+		long		 state;
+		const char	*name;
+	};
+
+	const StateName statenames[] = {
+		{ State::Active, "active" },
+		{ State::Hidden, "hidden" },
+		{ State::Sticky, "sticky" },
+		{ State::Urgent, "urgent" },
+		{ State::Frozen, "frozen" },
+		{ State::SkipPager, "skip-pager" },
+		{ State::SkipTaskbar, "skip-taskbar" },
+		{ State::FullScreen, "fullscreen" },
+		{ State::HMaximized, "horizontal-maximized" },
+		{ State::VMaximized, "vertical-maximized" },
+		{ State::Tiled, "tiled" },
+		{ State::NoTile, "notile" },
+		{ State::NoResize, "noresize" },
+		{ State::NoBorder, "noborder" },
+		{ State::Outline, "outline" },
+	};
+
+	static const char *query_screen(XScreen *, const long *, JsonWriter&);
+	static const char *query_desktops(XScreen *, const long *, JsonWriter&);
+	static const char *query_layouts(XScreen *, const long *, JsonWriter&);
+	static const char *query_clients(XScreen *, const long *, JsonWriter&);
+	static const char *query_client(XScreen *, const long *, JsonWriter&);
+	static void	 write_client(XClient *, JsonWriter&);
+	static void	 write_geometry(const Geometry&, JsonWriter&);
+
+	const QueryDef querydefs[] = {
+		{ "query-screen", query_screen },
+		{ "query-desktops", query_desktops },
+		{ "query-layouts", query_layouts },
+		{ "query-clients", query_clients },
+		{ "query-client", query_client },
+	};
+}
+
+// Run the query if it exists and store its JSON reply. The parameter is
+// NULL if none was given.
+bool query::run(XScreen *screen, std::string_view name, const long *param,
+		std::string &reply)
+{
+	for (const QueryDef &def : querydefs) {
+		if (name != def.name) continue;
+		// Lay out first the changes made by previous commands, unless
+		// they are part of a transaction being committed
+		if (!socket_in::committing())
+			screen->update_layout();
+		JsonWriter json(reply);
+		json.begin_object().key("status").value("ok").key("result");
+		const char *error = (*def.fquery)(screen, param, json);
+		json.end_object();
+		if (error) {
+			JsonWriter(reply).begin_object().key("status").value("error")
+				.key("error").value(error).end_object();
+		}
+		return true;
+	}
+	return false;
+}
+
+static const char *query::query_screen(XScreen *screen, const long *,
+					JsonWriter &json)
+{
+	XClient *active = screen->get_active_client();
+	Geometry view = screen->get_view();
+	json.begin_object()
+		.key("screen").value(screen->get_screenid())
+		.key("width").value(view.w)
+		.key("height").value(view.h)
+		.key("desktops").value(screen->get_num_desktops())
+		.key("desknum").value(screen->get_active_desktop() + 1)
+		.key("last_desknum").value(screen->get_last_desktop() + 1)
+		.key("active_window");
+	if (active)
+		json.value(active->get_window());
+	else
+		json.null();
+	json.key("viewports").begin_array();
+	for (Viewport &v : screen->get_viewports()) {
+		json.begin_object().key("num").value(v.get_num()).key("view");
+		write_geometry(v.get_view(), json);
+		json.key("work");
+		write_geometry(v.get_work(), json);
+		json.end_object();
+	}
+	json.end_array().end_object();
+	return NULL;
+}
+
+static const char *query::query_desktops(XScreen *screen, const long *,
+					JsonWriter &json)
+{
+	std::vector<Desktop> &desktops = screen->get_desktops();
+	std::vector<long> nclients(desktops.size(), 0);
+	for (XClient *client : screen->get_clients()) {
+		long index = client->get_desktop_index();
+		if ((index >= 0) && (index < (long)nclients.size()))
+			nclients[index]++;
+	}
+
+	json.begin_array();
+	for (size_t i = 0; i < desktops.size(); i++) {
+		Desktop &desktop = desktops[i];
+		json.begin_object()
+			.key("desknum").value((long)i + 1)
+			.key("name").value(desktop.get_name())
+			.key("layout")
+			.value(conf::desktop_layouts[desktop.get_layout_index()].name)
+			.key("master_split").value((double)desktop.get_master_split())
+			.key("clients").value(nclients[i])
+			.key("state");
+		if ((long)i == screen->get_active_desktop())
+			json.value("active");
+		else if (screen->desktop_urgent(i))
+			json.value("urgent");
+		else if (nclients[i])
+			json.value("hidden");
+		else
+			json.value("empty");
+		json.end_object();
+	}
+	json.end_array();
+	return NULL;
+}
+
+// Layouts of the active desktop
+static const char *query::query_layouts(XScreen *screen, const long *,
+					JsonWriter &json)
+{
+	Desktop &desktop = screen->get_desktops()[screen->get_active_desktop()];
+	json.begin_array();
+	for (size_t i = 0; i < conf::desktop_layouts.size(); i++) {
+		json.begin_object()
+			.key("name").value(conf::desktop_layouts[i].name)
+			.key("active").value((long)i == desktop.get_layout_index())
+			.end_object();
+	}
+	json.end_array();
+	return NULL;
+}
+
+static const char *query::query_clients(XScreen *screen, const long *,
+					JsonWriter &json)
+{
+	json.begin_array();
+	for (XClient *client : screen->get_clients())
+		write_client(client, json);
+	json.end_array();
+	return NULL;
+}
+
+// Client with the given window id, or the active client if no id is given.
+static const char *query::query_client(XScreen *screen, const long *window,
+					JsonWriter &json)
+{
+	XClient *client = NULL;
+	if (window) {
+		client = XScreen::find_client(*window);
+		if (!client || (client->get_screen() != screen))
+			return "unknown window";
+	} else
+		client = screen->get_active_client();
+
+	if (client)
+		write_client(client, json);
+	else
+		json.null();
+	return NULL;
+}
+
+static void query::write_client(XClient *client, JsonWriter &json)
+{
+	json.begin_object()
+		.key("window").value(client->get_window())
+		.key("name").value(client->get_name())
+		.key("instance").value(client->get_res_name())
+		.key("class").value(client->get_res_class())
+		// Sticky clients are on desktop 0
+		.key("desknum").value(client->get_desktop_index() + 1)
+		.key("geometry");
+	write_geometry(client->get_geometry(), json);
+	json.key("border").value(client->get_border());
+	json.key("states").begin_array();
+	for (const StateName &s : statenames) {
+		if (client->has_state(s.state))
+			json.value(s.name);
+	}
+	json.end_array().end_object();
+}
+
+static void query::write_geometry(const Geometry &g, JsonWriter &json)
+{
+	json.begin_object()
+		.key("x").value(g.x).key("y").value(g.y)
+		.key("w").value(g.w).key("h").value(g.h)
+		.end_object();
+}
@@ -22,20 +22,100 @@
 
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <fcntl.h>
 #include <netdb.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <deque>
 #include <filesystem>
 #include <iostream>
-#include <regex>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "timer.h"
+#include "config.h"
+#include "evloop.h"
+#include "events.h"
+#include "wmcore.h"
 #include "socket.h"
 
+// Commands are read on non-blocking connections that stay open until the
+// client closes them. Each line is a command and any number of commands
+// can be sent on the same connection. Each command gets a one line reply.
+//
+// A client that subscribes to some topics also receives the messages of
+// these topics. A message is serialized once and shared by the queues of
+// the subscribers. Each queue is bounded: when it is full, the oldest
+// message is dropped, which the subscriber sees as a gap in the sequence.
+//
+// The commands sent between "begin" and "commit" are held and run together
+// when the transaction is committed, so that the screen is laid out, the
+// root properties are written and the panel is updated only once for all
+// of them. Their replies are sent at commit, followed by the reply to it.
 namespace socket_in {
-	int socket_fd = -1;
-	std::string message = "";
+	const size_t	 MaxClients = 64;
+	const size_t	 MaxLine = 4096;
+	const size_t	 MaxRead = 65536;	// bytes read per wakeup and client
+	const size_t	 MaxReply = 1 << 20;	// bytes of replies not yet read
+	const size_t	 MaxEvents = 256;	// messages queued per subscriber
+	const size_t	 MaxBatch = 1024;	// commands held in a transaction
+	const int	 MaxIov = 64;
+
+	struct Event {
+		unsigned long			 seq;
+		std::shared_ptr<const std::string> body;	// without the first '{'
+	};
+
+	struct Client {
+		std::string	 input;
+		std::string	 output;
+		bool		 eof;
+		long		 filter;	// watched in the event loop
+		long		 topics;	// subscribed topics
+		std::deque<Event> events;
+		size_t		 offset;	// bytes of the first event already sent
+		unsigned long	 seq;
+		bool		 transaction;
+		std::vector<std::string> batch;	// commands held until commit
+		size_t		 overflow;	// commands beyond MaxBatch
+		Client(): eof(false), filter(IoRead), topics(0), offset(0), seq(0),
+			transaction(false), overflow(0) {}
+	};
+
+	int		 socket_fd = -1;
+	CommandHandler	 handler = NULL;
+	std::unordered_map<int, Client> clients;
+	long		 topics = 0;	// subscribed by any client
+	unsigned long	 accepted = 0;
+	unsigned long	 rejected = 0;
+	unsigned long	 commands = 0;
+	unsigned long	 dropped = 0;
+	unsigned long	 transactions = 0;
+	bool		 in_commit = false;
+
+	static void	 accept_clients(int, long);
+	static void	 handle_client(int, long);
+	static void	 read_client(int, Client &);
+	static bool	 write_client(int, Client &);
+	static bool	 write_events(int, Client &, size_t);
+	static void	 close_client(int);
+	static void	 run_command(std::string &, Client &);
+	static void	 execute_command(const std::string &, Client &);
+	static bool	 run_transaction(std::string_view, Client &);
+	static void	 end_transaction(Client &, bool);
+	static bool	 run_subscription(std::string_view, Client &);
+	static void	 queue_event(Client &, std::shared_ptr<const std::string>&);
+	static void	 queue_snapshot(Client &);
+	static void	 update_topics();
+	static void	 update_filter(int, Client &);
 }
 
-int socket_in::init(std::string &name)
+int socket_in::init(std::string &name, CommandHandler h)
 {
 	int res = 0;
 	bool unix_socket = false;
@@ -82,6 +162,8 @@ int socket_in::init(std::string &name)
 		freeaddrinfo(result);
 		return -1;
 	}
+	fcntl(socket_fd, F_SETFD, FD_CLOEXEC);
+	fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) | O_NONBLOCK);
 
 	if (bind(socket_fd, result->ai_addr, result->ai_addrlen) < 0) {
 		std::cerr << "bind: " << std::strerror(errno) << std::endl;
@@ -92,38 +174,450 @@ int socket_in::init(std::string &name)
 	if (unix_socket)
 		std::filesystem::permissions(socket_name, std::filesystem::perms::owner_all);
 
-	if (listen(socket_fd, 5) < 0) {
+	if (listen(socket_fd, SOMAXCONN) < 0) {
 		std::cerr << "listen failed on socket [" << name << "]!\n";
 	}
 
 	freeaddrinfo(result);
+	handler = h;
+	if (!evloop::watch(socket_fd, IoRead, accept_clients))
+		return -1;
 	return socket_fd;
 }
 
-const std::string& socket_in::get_message()
+void socket_in::clear()
+{
+	while (!clients.empty())
+		close_client(clients.begin()->first);
+	if (socket_fd != -1) {
+		evloop::unwatch(socket_fd);
+		close(socket_fd);
+	}
+	socket_fd = -1;
+}
+
+const socket_in::Stats socket_in::get_stats()
+{
+	return Stats { accepted, rejected, commands, dropped, transactions };
+}
+
+// True while the commands of a transaction are run
+bool socket_in::committing()
+{
+	return in_commit;
+}
+
+bool socket_in::subscribed(long topic)
+{
+	return (topics & topic);
+}
+
+// Queue the message for the subscribers of its topic. It is written when
+// their socket becomes writable.
+void socket_in::publish(long topic, const std::string &message)
+{
+	if (!(topics & topic) || message.empty()) return;
+	std::shared_ptr<const std::string> body;
+	for (auto &[fd, client] : clients) {
+		if (!(client.topics & topic)) continue;
+		if (!body) {
+			std::string str;
+			str.reserve(message.length());
+			str.append(message, 1, std::string::npos).push_back('\n');
+			body = std::make_shared<const std::string>(std::move(str));
+		}
+		queue_event(client, body);
+		update_filter(fd, client);
+	}
+}
+
+// Accept all pending connections.
+static void socket_in::accept_clients(int, long)
+{
+	for (;;) {
+		int fd = accept(socket_fd, NULL, NULL);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				std::cerr << "accept: " << std::strerror(errno) << std::endl;
+			return;
+		}
+		if (clients.size() >= MaxClients) {
+			close(fd);
+			rejected++;
+			continue;
+		}
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		if (!evloop::watch(fd, IoRead, handle_client)) {
+			close(fd);
+			rejected++;
+			continue;
+		}
+		clients[fd];
+		accepted++;
+	}
+}
+
+static void socket_in::handle_client(int fd, long filter)
+{
+	auto it = clients.find(fd);
+	if (it == clients.end()) return;
+	Client &client = it->second;
+
+	if ((filter & IoRead) && !client.eof)
+		read_client(fd, client);
+
+	// Replies are written at once and the rest when the socket is writable
+	if (!write_client(fd, client)) {
+		close_client(fd);
+		return;
+	}
+	if (client.output.length() > MaxReply) {
+		std::cerr << "replies not read on socket, closing connection\n";
+		close_client(fd);
+		return;
+	}
+	if (client.eof && client.output.empty() && client.events.empty()) {
+		close_client(fd);
+		return;
+	}
+	update_filter(fd, client);
+}
+
+// Watch for writability only while something is waiting to be written
+static void socket_in::update_filter(int fd, Client &client)
+{
+	long filter = client.eof ? 0 : IoRead;
+	if (!client.output.empty() || !client.events.empty())
+		filter |= IoWrite;
+	if (filter == client.filter) return;
+	client.filter = filter;
+	evloop::modify(fd, filter);
+}
+
+// Read what is available and run every complete command.
+static void socket_in::read_client(int fd, Client &client)
+{
+	std::string &buffer = client.input;
+	char data[4096];
+	size_t total = 0;
+	while (total < MaxRead) {
+		ssize_t n = read(fd, data, sizeof(data));
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				client.eof = true;
+			break;
+		}
+		if (n == 0) {
+			client.eof = true;
+			break;
+		}
+		buffer.append(data, n);
+		total += n;
+	}
+
+	size_t start = 0, end;
+	while ((end = buffer.find('\n', start)) != std::string::npos) {
+		std::string command = buffer.substr(start, end - start);
+		run_command(command, client);
+		start = end + 1;
+	}
+	buffer.erase(0, start);
+
+	// A command without newline is accepted at end of file. A transaction
+	// that is not committed is discarded.
+	if (client.eof) {
+		if (!buffer.empty()) run_command(buffer, client);
+		buffer.clear();
+		if (client.transaction) end_transaction(client, false);
+	} else if (buffer.length() > MaxLine) {
+		std::cerr << "command too long on socket, closing connection\n";
+		client.eof = true;
+		buffer.clear();
+	}
+}
+
+// Write the pending replies, then the queued messages. Return false if
+// the connection is broken.
+static bool socket_in::write_client(int fd, Client &client)
+{
+	// A partially sent message is completed before any reply
+	if (client.offset) {
+		if (!write_events(fd, client, 1)) return false;
+		if (client.offset) return true;
+	}
+	while (!client.output.empty()) {
+		ssize_t n = ::send(fd, client.output.data(), client.output.length(),
+					MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			return (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+		client.output.erase(0, n);
+	}
+	return write_events(fd, client, client.events.size());
+}
+
+// Each message is written as its sequence number followed by the shared
+// body, in a single gather write for as many messages as possible, up to
+// limit messages.
+static bool socket_in::write_events(int fd, Client &client, size_t limit)
+{
+	struct iovec iov[MaxIov];
+	char prefix[MaxIov/2][32];
+	size_t length[MaxIov/2];
+	struct msghdr msg;
+
+	while (!client.events.empty() && limit) {
+		int niov = 0, nevents = 0;
+		size_t skip = client.offset;
+		for (Event &event : client.events) {
+			if ((niov > MaxIov - 2) || ((size_t)nevents == limit)) break;
+			char *p = prefix[nevents];
+			memcpy(p, "{\"seq\":", 7);
+			char *end = std::to_chars(p + 7, p + sizeof(prefix[0]) - 1,
+							event.seq).ptr;
+			if (event.body->compare(0, 1, "}")) *end++ = ',';
+			size_t plen = end - p;
+			length[nevents++] = plen + event.body->length();
+			if (skip < plen) {
+				iov[niov].iov_base = p + skip;
+				iov[niov++].iov_len = plen - skip;
+				skip = 0;
+			} else
+				skip -= plen;
+			iov[niov].iov_base = (void *)(event.body->data() + skip);
+			iov[niov++].iov_len = event.body->length() - skip;
+			skip = 0;
+		}
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = niov;
+		ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			return (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+
+		// Remove the messages that were completely sent
+		size_t written = n + client.offset;
+		for (int i = 0; (i < nevents) && (written >= length[i]); i++) {
+			written -= length[i];
+			client.events.pop_front();
+			limit--;
+		}
+		client.offset = written;
+	}
+	return true;
+}
+
+static void socket_in::close_client(int fd)
+{
+	evloop::unwatch(fd);
+	close(fd);
+	auto it = clients.find(fd);
+	bool subscriber = (it != clients.end()) && it->second.topics;
+	clients.erase(fd);
+	if (subscriber) update_topics();
+}
+
+static void socket_in::update_topics()
+{
+	topics = 0;
+	for (auto &entry : clients)
+		topics |= entry.second.topics;
+}
+
+static void socket_in::queue_event(Client &client,
+				std::shared_ptr<const std::string> &body)
+{
+	if (client.events.size() >= MaxEvents) {
+		// Drop the oldest message, unless it is partially sent
+		auto it = client.events.begin();
+		if (client.offset) it++;
+		client.events.erase(it);
+		dropped++;
+	}
+	client.events.push_back(Event { ++client.seq, body });
+}
+
+// The snapshot is the first message sent to a new subscriber
+static void socket_in::queue_snapshot(Client &client)
+{
+	std::string messages;
+	events::get_snapshot(messages);
+	size_t start = 0, end;
+	while ((end = messages.find('\n', start)) != std::string::npos) {
+		if (end > start + 1) {
+			std::shared_ptr<const std::string> body =
+				std::make_shared<const std::string>(
+					messages.substr(start + 1, end - start));
+			queue_event(client, body);
+		}
+		start = end + 1;
+	}
+}
+
+// subscribe [topic,...], unsubscribe and snapshot
+static bool socket_in::run_subscription(std::string_view command, Client &client)
 {
-	message = "";
-	int fd2 = accept(socket_fd, NULL, NULL);
-	if (fd2 < 0) {
-		std::cerr << "error on accept" << std::endl;
-		close(fd2);
-		return message;
+	std::string_view verb = command.substr(0, command.find(' '));
+	std::string_view args = (verb.length() < command.length()) ?
+				command.substr(verb.length() + 1) : "";
+	if (verb == "subscribe") {
+		long t = args.empty() ? (long)TopicAll : events::get_topics(args);
+		if (t <= 0) {
+			client.output.append("{\"status\":\"error\",\"error\":\"unknown topic\"}\n");
+			return true;
+		}
+		// The snapshot is taken before the client receives any message,
+		// so that the pending changes it includes are not sent to it
+		if (!client.topics) queue_snapshot(client);
+		client.topics = t;
+		update_topics();
+		client.output.append("{\"status\":\"ok\"}\n");
+		return true;
+	}
+	if (verb == "unsubscribe") {
+		client.topics = 0;
+		// A partially sent message must still be completed
+		auto it = client.events.begin();
+		if (client.offset) it++;
+		client.events.erase(it, client.events.end());
+		update_topics();
+		client.output.append("{\"status\":\"ok\"}\n");
+		return true;
 	}
-	char buffer[1024];
-	bzero(buffer, 1024);
-	if (read(fd2, buffer, 1023) < 0) {
-		std::cerr << "error on read" << std::endl;
-		close(fd2);
-		return message;
+	if (verb == "snapshot") {
+		if (!client.topics) {
+			client.output.append("{\"status\":\"error\",\"error\":\"not subscribed\"}\n");
+			return true;
+		}
+		client.output.append("{\"status\":\"ok\"}\n");
+		queue_snapshot(client);
+		return true;
+	}
+	return false;
+}
+
+static void socket_in::run_command(std::string &command, Client &client)
+{
+	if (!command.empty() && command.back() == '\r')
+		command.pop_back();
+	if (command.empty()) return;
+	commands++;
+	if (run_transaction(command, client)) return;
+	if (client.transaction) {
+		if (client.batch.size() < MaxBatch)
+			client.batch.push_back(command);
+		else
+			client.overflow++;
+		return;
 	}
-	close(fd2);
-	message = std::regex_replace(std::string(buffer), std::regex("\\r\\n|\\r|\\n"), "");
-	return message;
+	execute_command(command, client);
 }
 
+static void socket_in::execute_command(const std::string &command, Client &client)
+{
+	if (run_subscription(command, client)) return;
+
+	std::string reply;
+	if (handler) (*handler)(command, reply);
+	client.output.append(reply);
+	client.output.push_back('\n');
+}
+
+// begin, commit and abort
+static bool socket_in::run_transaction(std::string_view command, Client &client)
+{
+	// A nested begin is held with the other commands to keep the replies
+	// in order.
+	if (command == "begin" && !client.transaction) {
+		client.transaction = true;
+		client.output.append("{\"status\":\"ok\"}\n");
+		return true;
+	}
+	if (command == "commit" || command == "abort") {
+		if (!client.transaction) {
+			client.output.append("{\"status\":\"error\",\"error\":\"no transaction\"}\n");
+			return true;
+		}
+		if (command == "abort") {
+			end_transaction(client, false);
+			client.output.append("{\"status\":\"ok\"}\n");
+			return true;
+		}
+		if (client.overflow) {
+			end_transaction(client, false);
+			client.output.append("{\"status\":\"error\",\"error\":\"transaction too large\"}\n");
+			return true;
+		}
+		end_transaction(client, true);
+		client.output.append("{\"status\":\"ok\"}\n");
+		return true;
+	}
+	return false;
+}
+
+// Run the commands held in the transaction, or reply to each of them
+// that it was not run.
+static void socket_in::end_transaction(Client &client, bool commit)
+{
+	std::vector<std::string> batch;
+	batch.swap(client.batch);
+	size_t count = batch.size() + client.overflow;
+	client.transaction = false;
+	client.overflow = 0;
+
+	if (commit) {
+		transactions++;
+		in_commit = true;
+		for (std::string &command : batch) {
+			if (command == "begin")
+				client.output.append("{\"status\":\"error\",\"error\":\"transaction already open\"}\n");
+			else
+				execute_command(command, client);
+		}
+		in_commit = false;
+		return;
+	}
+	for (size_t i = 0; i < count; i++)
+		client.output.append("{\"status\":\"error\",\"error\":\"transaction aborted\"}\n");
+}
+
+// Messages to the panel are queued in a ring buffer and written on a
+// persistent non-blocking connection when the socket is writable. When the
+// queue is full, the oldest message is dropped. Each message is numbered,
+// so the panel can detect a gap and ask for a new snapshot of the state.
 namespace socket_out {
-	struct addrinfo *address;
-	bool valid_addr = false;
+	const size_t	 QueueSize = 256;
+	const long	 RetryMin = 100;	// msec
+	const long	 RetryMax = 10000;	// msec
+	const int	 MaxIov = 64;
+
+	struct addrinfo	*address;
+	bool		 valid_addr = false;
+	int		 fd = -1;
+	bool		 connected = false;
+	long		 retry_delay = RetryMin;
+	std::string	 input;
+	unsigned long	 seq = 0;
+
+	std::vector<std::string> queue(QueueSize);
+	size_t		 head = 0;
+	size_t		 count = 0;
+	size_t		 offset = 0;	// bytes of the head message already sent
+	unsigned long	 sent = 0;
+	unsigned long	 dropped = 0;
+
+	static void	 open_connection();
+	static void	 close_connection();
+	static void	 handle_io(int, long);
+	static void	 flush();
+	static void	 send_snapshot();
 }
 
 void socket_out::init(std::string &socket_name)
@@ -133,7 +627,7 @@ void socket_out::init(std::string &socket_name)
 	memset(&hint, 0, sizeof(hint));
 	hint.ai_socktype = SOCK_STREAM;
 
-	if (valid_addr) freeaddrinfo(address);
+	if (valid_addr) clear();
 	size_t pos = socket_name.find(":");
 	if (pos != std::string::npos) {
 		std::string hostname = socket_name.substr(0, pos);
@@ -151,42 +645,202 @@ void socket_out::init(std::string &socket_name)
 			<< gai_strerror(rc) << "\n";
 	} else {
 		valid_addr = true;
+		open_connection();
 	}
 }
 
-bool socket_out::defined()
+// Messages are only sent while the panel is connected
+bool socket_out::active()
 {
-	return valid_addr;
+	return connected;
 }
 
 void socket_out::clear()
 {
+	if (fd != -1) {
+		flush();
+		close_connection();
+	}
+	evloop::cancel(open_connection);
 	if (valid_addr) freeaddrinfo(address);
 	valid_addr = false;
+	head = count = 0;
 }
 
-int socket_out::send(std::string &message)
+// Queue a message with its sequence number added as first key. It is
+// written at once if the socket is writable.
+int socket_out::send(const std::string &message)
 {
-	if (!valid_addr) return 0;
+	if (!connected || message.empty()) return 0;
 
-	int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+	if (count == QueueSize) {
+		// Drop the oldest message, unless it is partially sent
+		if (offset) {
+			std::swap(queue[head], queue[(head + 1) % QueueSize]);
+			head = (head + 1) % QueueSize;
+		} else {
+			head = (head + 1) % QueueSize;
+		}
+		count--;
+		dropped++;
+	}
+	char number[24];
+	auto res = std::to_chars(number, number + sizeof(number), ++seq);
+	std::string &entry = queue[(head + count) % QueueSize];
+	entry.assign("{\"seq\":");
+	entry.append(number, res.ptr - number);
+	if (message.compare(0, 2, "{}")) entry.push_back(',');
+	entry.append(message, 1, std::string::npos);
+	count++;
+
+	if (connected) flush();
+	return message.length();
+}
+
+const socket_out::Stats socket_out::get_stats()
+{
+	return Stats { sent, dropped, count };
+}
+
+static void socket_out::open_connection()
+{
+	fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
 	if (fd < 0) {
 		std::cerr << "Cannot create socket!\n";
-		return -1;
+		return;
 	}
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
 
-	if (connect(fd, address->ai_addr, address->ai_addrlen) < 0) {
-		std::cerr << "Cannot connect to message socket!\n";
+	// The connection is established when the socket becomes writable
+	if ((connect(fd, address->ai_addr, address->ai_addrlen) < 0) &&
+		(errno != EINPROGRESS)) {
+		if (conf::debug) {
+			std::cout << timer::gettime() << " [socket_out::" << __func__
+				<< "] Cannot connect to message socket: "
+				<< std::strerror(errno) << std::endl;
+		}
+		close_connection();
+		return;
+	}
+	evloop::watch(fd, IoRead|IoWrite, handle_io);
+}
+
+// Close the connection and retry later, with an increasing delay.
+static void socket_out::close_connection()
+{
+	if (fd != -1) {
+		evloop::unwatch(fd);
 		close(fd);
-		return -1;
 	}
+	fd = -1;
+	connected = false;
+	offset = 0;
+	input.clear();
+	if (!valid_addr || (wm::status != IsRunning)) return;
+
+	evloop::schedule(retry_delay, open_connection);
+	retry_delay = std::min(retry_delay * 2, RetryMax);
+}
+
+static void socket_out::handle_io(int, long filter)
+{
+	if (filter & IoRead) {
+		// The panel may only ask for a snapshot
+		char buffer[256];
+		ssize_t n = read(fd, buffer, sizeof(buffer));
+		if ((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EINTR))) {
+			close_connection();
+			return;
+		}
+		if (n > 0) input.append(buffer, n);
+		size_t pos;
+		while ((pos = input.find('\n')) != std::string::npos) {
+			if (!input.compare(0, pos, "snapshot") && connected)
+				send_snapshot();
+			input.erase(0, pos + 1);
+		}
+		if (input.length() > sizeof(buffer)) input.clear();
+	}
+
+	if ((filter & IoWrite) && !connected) {
+		int err = 0;
+		socklen_t len = sizeof(err);
+		getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+		if (err) {
+			if (conf::debug) {
+				std::cout << timer::gettime() << " [socket_out::" << __func__
+					<< "] Cannot connect to message socket: "
+					<< std::strerror(err) << std::endl;
+			}
+			close_connection();
+			return;
+		}
+		connected = true;
+		retry_delay = RetryMin;
 
-	message += '\n';
-	int rc = write(fd, message.c_str(), message.length());
-	if (rc < 0) {
-		std::cerr << "Failed to send message!\n";
+		// Messages queued for the previous connection are superseded
+		// by a snapshot of the current state.
+		head = count = offset = 0;
+		send_snapshot();
 	}
+	if (filter & IoWrite) flush();
+}
 
-	close(fd);
-	return rc;
+// Write as many queued messages as the socket accepts, each followed by
+// a newline. MSG_NOSIGNAL avoids a SIGPIPE if the panel is gone.
+static void socket_out::flush()
+{
+	static char newline = '\n';
+	struct iovec iov[MaxIov];
+	struct msghdr msg;
+
+	if (!connected) return;
+	while (count) {
+		int niov = 0;
+		size_t skip = offset;
+		for (size_t i = 0; (i < count) && (niov < MaxIov - 1); i++) {
+			std::string &str = queue[(head + i) % QueueSize];
+			if (skip < str.length()) {
+				iov[niov].iov_base = (void *)(str.data() + skip);
+				iov[niov++].iov_len = str.length() - skip;
+			}
+			iov[niov].iov_base = &newline;
+			iov[niov++].iov_len = 1;
+			skip = 0;
+		}
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = niov;
+		ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			close_connection();
+			return;
+		}
+
+		// Remove the messages that were completely sent
+		size_t written = n + offset;
+		while (count && (written >= queue[head].length() + 1)) {
+			written -= queue[head].length() + 1;
+			head = (head + 1) % QueueSize;
+			count--;
+			sent++;
+		}
+		offset = written;
+	}
+	evloop::modify(fd, count ? IoRead|IoWrite : IoRead);
+}
+
+static void socket_out::send_snapshot()
+{
+	std::string messages;
+	events::get_snapshot(messages);
+	size_t start = 0, end;
+	while ((end = messages.find('\n', start)) != std::string::npos) {
+		send(messages.substr(start, end - start));
+		start = end + 1;
+	}
 }
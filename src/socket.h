@@ -24,15 +24,34 @@
 #define _SOCKET_H_
 #include <string>
 
+typedef void (*CommandHandler)(const std::string&, std::string&);
+
 namespace socket_in {
-	int init(std::string &);
-	const std::string& get_message();
+	struct Stats {
+		unsigned long	accepted;
+		unsigned long	rejected;
+		unsigned long	commands;
+		unsigned long	dropped;
+		unsigned long	transactions;
+	};
+	int init(std::string &, CommandHandler);
+	void clear();
+	bool committing();
+	bool subscribed(long);
+	void publish(long, const std::string&);
+	const Stats get_stats();
 }
 
 namespace socket_out {
+	struct Stats {
+		unsigned long	sent;
+		unsigned long	dropped;
+		unsigned long	queued;
+	};
 	void init(std::string&);
-	int send(std::string&);
-	bool defined();
+	int send(const std::string&);
+	bool active();
 	void clear();
+	const Stats get_stats();
 }
 #endif // _SOCKET_H_
@@ -0,0 +1,151 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "enums.h"
+#include "timer.h"
+#include "config.h"
+#include "xclient.h"
+#include "xscreen.h"
+#include "stateexport.h"
+
+static_assert(ZWM_CLIENT_ACTIVE == State::Active);
+static_assert(ZWM_CLIENT_HIDDEN == State::Hidden);
+static_assert(ZWM_CLIENT_STICKY == State::Sticky);
+static_assert(ZWM_CLIENT_URGENT == State::Urgent);
+static_assert(ZWM_CLIENT_FROZEN == State::Frozen);
+static_assert(ZWM_CLIENT_SKIP_PAGER == State::SkipPager);
+static_assert(ZWM_CLIENT_SKIP_TASKBAR == State::SkipTaskbar);
+static_assert(ZWM_CLIENT_FULLSCREEN == State::FullScreen);
+static_assert(ZWM_CLIENT_HMAXIMIZED == State::HMaximized);
+static_assert(ZWM_CLIENT_VMAXIMIZED == State::VMaximized);
+static_assert(ZWM_CLIENT_TILED == State::Tiled);
+static_assert(ZWM_CLIENT_NOTILE == State::NoTile);
+
+StateExport::StateExport(std::string &path, int screen): m_path(path)
+{
+	m_state = NULL;
+	m_fd = open(m_path.c_str(), O_RDWR|O_CREAT|O_TRUNC|O_CLOEXEC, 0600);
+	if (m_fd < 0) {
+		std::cerr << timer::gettime() << " [StateExport::" << __func__ << "] "
+			<< m_path << ": " << std::strerror(errno) << std::endl;
+		return;
+	}
+	if (ftruncate(m_fd, sizeof(struct zwm_state)) < 0) {
+		std::cerr << timer::gettime() << " [StateExport::" << __func__ << "] "
+			<< m_path << ": " << std::strerror(errno) << std::endl;
+		return;
+	}
+	void *addr = mmap(NULL, sizeof(struct zwm_state), PROT_READ|PROT_WRITE,
+				MAP_SHARED, m_fd, 0);
+	if (addr == MAP_FAILED) {
+		std::cerr << timer::gettime() << " [StateExport::" << __func__ << "] "
+			<< m_path << ": " << std::strerror(errno) << std::endl;
+		return;
+	}
+
+	// The file is new and filled with zeros: readers ignore it until
+	// the magic number is written with the first update.
+	m_state = (struct zwm_state *)addr;
+	m_state->version = ZWM_STATE_VERSION;
+	m_state->size = sizeof(struct zwm_state);
+	m_state->screen = screen;
+}
+
+StateExport::~StateExport()
+{
+	if (m_state)
+		munmap(m_state, sizeof(struct zwm_state));
+	if (m_fd >= 0) {
+		close(m_fd);
+		unlink(m_path.c_str());
+	}
+}
+
+// Write the state of the screen. The sequence number is odd while the
+// region is being written.
+void StateExport::update(XScreen *screen)
+{
+	if (!m_state) return;
+	struct zwm_state *s = m_state;
+	uint32_t seq = s->seq;
+	__atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	s->truncated = 0;
+	s->active_desktop = screen->get_active_desktop();
+	s->ndesktops = std::min<long>(screen->get_num_desktops(),
+					ZWM_STATE_MAX_DESKTOPS);
+	for (uint32_t i = 0; i < ZWM_STATE_MAX_DESKTOPS; i++)
+		s->desktop_flags[i] = 0;
+	if (s->active_desktop < ZWM_STATE_MAX_DESKTOPS)
+		s->desktop_flags[s->active_desktop] |= ZWM_DESKTOP_ACTIVE;
+
+	XClient *active = screen->get_active_client();
+	s->active_window = active ? active->get_window() : 0;
+
+	// The first string is empty, and shared by the titles which do not fit
+	uint32_t n = 0, used = 1;
+	s->strings[0] = '\0';
+	for (XClient *client : screen->get_clients()) {
+		long index = client->get_desktop_index();
+		if ((index >= 0) && (index < ZWM_STATE_MAX_DESKTOPS)) {
+			s->desktop_flags[index] |= ZWM_DESKTOP_OCCUPIED;
+			if (client->has_state(State::Urgent))
+				s->desktop_flags[index] |= ZWM_DESKTOP_URGENT;
+		}
+		if (n == ZWM_STATE_MAX_CLIENTS) {
+			s->truncated = 1;
+			continue;
+		}
+		struct zwm_state_client &c = s->clients[n++];
+		c.window = client->get_window();
+		c.desktop = index;
+		c.states = client->get_states();
+
+		// Titles are NUL terminated. A title which does not fit is empty.
+		std::string &name = client->get_name();
+		if (used + name.length() + 1 > ZWM_STATE_STRINGS_SIZE) {
+			s->truncated = 1;
+			c.title_offset = 0;
+			c.title_length = 0;
+			continue;
+		}
+		memcpy(s->strings + used, name.c_str(), name.length() + 1);
+		c.title_offset = used;
+		c.title_length = name.length();
+		used += name.length() + 1;
+	}
+	s->nclients = n;
+	s->strings_used = used;
+	s->magic = ZWM_STATE_MAGIC;
+
+	__atomic_store_n(&s->seq, seq + 2, __ATOMIC_RELEASE);
+}
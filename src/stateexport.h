@@ -0,0 +1,43 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _STATEEXPORT_H_
+#define _STATEEXPORT_H_
+#include <string>
+#include "zwmstate.h"
+
+class XScreen;
+
+// Shared memory region describing the state of a screen, for readers
+// which map it instead of querying the window manager.
+class StateExport {
+	std::string		 m_path;
+	int			 m_fd;
+	struct zwm_state	*m_state;
+public:
+	StateExport(std::string&, int);
+	~StateExport();
+	StateExport(const StateExport&) = delete;
+	bool			 is_valid() const { return m_state != NULL; }
+	void			 update(XScreen *);
+};
+#endif /* _STATEEXPORT_H_ */
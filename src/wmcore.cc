@@ -20,21 +20,30 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <sys/event.h>
 #include <unistd.h>
+#include <csignal>
+#include <cstdlib>
 #include <X11/cursorfont.h>
 #include <X11/extensions/Xrandr.h>
+#include <X11/extensions/sync.h>
 #include <X11/Xlib.h>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "timer.h"
+#include "evloop.h"
+#include "events.h"
 #include "process.h"
+#include "query.h"
 #include "socket.h"
+#include "bind.h"
 #include "config.h"
+#include "xclient.h"
+#include "xpointer.h"
 #include "xscreen.h"
 #include "xevents.h"
 #include "wmfunc.h"
@@ -49,6 +58,8 @@ namespace wm {
 
 	int				 xrandr;
 	int				 xrandr_event_base;
+	int				 xsync;
+	int				 xsync_event_base;
 
 	std::vector<XScreen*>		 screenlist;
 
@@ -66,13 +77,16 @@ namespace wm {
 
 	static void	wm_startup(void);
 	static void	wm_shutdown(void);
-	static void 	process_message(void);
+	static void	x_events(int, long);
+	static void 	process_message(const std::string&, std::string&);
+	static void 	get_snapshot(std::string&);
 	static int 	start_error_handler(Display *, XErrorEvent *);
 	static int	error_handler(Display *, XErrorEvent *);
 }
 
 void wm::run()
 {
+	events::init(get_snapshot);
 	if (conf::message_socket.length()) {
 		socket_out::init(conf::message_socket);
 	}
@@ -81,57 +95,48 @@ void wm::run()
 		process::exec(conf::startupscript);
 	wm_startup();
 
-	int kq = kqueue();
-	if (kq == -1) {
-		std::cerr << " [wm:: " << __func__ << "] kqueue "
-				<< std::strerror(errno) << std::endl;
-		exit(1);
-	}
-
-	int n = 0;
-	struct kevent watch[2];
 	long xfd = ConnectionNumber(display);
 	if (xfd == -1L) {
 		std::cerr << " [wm::" << __func__ << "] bad X connection number\n";
 		exit(1);
 	}
-	EV_SET(&watch[n++], xfd, EVFILT_READ, EV_ADD, 0, 0, 0);
+	if (!evloop::watch(xfd, IoFilter::IoRead, x_events))
+		exit(1);
 
-	long sfd = socket_in::init(conf::command_socket);
-	if (sfd == -1L) {
+	if (socket_in::init(conf::command_socket, process_message) == -1) {
 		std::cerr << " [wm::" << __func__ << "] error creating socket "
 			<< conf::command_socket << std::endl;
 		exit(1);
 	}
-	EV_SET(&watch[n++], sfd, EVFILT_READ, EV_ADD, 0, 0, 0);
-
-	if (kevent(kq, watch, n, NULL, 0, NULL) == -1) {
-		std::cerr << " [wm::" << __func__ << "] kevent(setup) "
-			<< std::strerror(errno) << std::endl;
-		exit(1);
-	}
 
 	// Main event loop
 	status = IsRunning;
-	struct kevent events[2];
 	while (status == IsRunning) {
-		int nev = kevent(kq, NULL, 0, events, n, NULL);
-		if ((nev == -1) && (errno != EINTR)) {
-			std::cerr << " [wm::" << __func__ << "] kevent "
-				<< std::strerror(errno) << std::endl;
-		}
-		for (int i=0; i<nev; i++) {
-			if ((long)events[i].ident == xfd)
+		// Lay out the desktops, write the root properties and send
+		// the panel changes since the last iteration. Events may have
+		// been queued by Xlib while handling commands or layouts.
+		do {
+			if (QLength(display))
 				XEvents::process();
-			else if ((long)events[i].ident == sfd) {
-				process_message();
+			for (XScreen *screen : screenlist) {
+				screen->update_layout();
+				screen->update_root_properties();
+				screen->update_panel();
+				screen->update_state_export();
 			}
-		}
+		} while (QLength(display));
+		XFlush(display);
+		xpointer::invalidate();
+		evloop::dispatch();
 	}
 	wm_shutdown();
 
+	evloop::clear();
 	closefrom(3);
 	if (status == IsRestarting) {
+		sigset_t mask;
+		sigemptyset(&mask);
+		sigprocmask(SIG_SETMASK, &mask, NULL);
 		setsid();
 		execvp((char *)restart_argv[0], (char **)restart_argv.data());
 		std::cerr << "[wm::" << __func__ << "]'" << restart_argv[0]
@@ -142,21 +147,26 @@ void wm::run()
 		process::exec(conf::shutdownscript);
 }
 
-// Process message received on the listening socket
-static void wm::process_message()
+static void wm::x_events(int, long)
+{
+	XEvents::process();
+}
+
+// Process a command received on the listening socket and store the reply
+static void wm::process_message(const std::string &message, std::string &reply)
 {
 	if (conf::debug) {
-		std::cout << timer::gettime() << " [wm::" << __func__ << "]\n";
+		std::cout << timer::gettime() << " [wm::" << __func__ << "] "
+			<< message << std::endl;
 	}
-	std::istringstream iss(socket_in::get_message());
 
-	int id;
-	std::string screenid;
-	if (!std::getline(iss, screenid, ':'))
-		return;
-	try {
-		id = std::stoi(screenid);
-	} catch(...) {
+	// The format is screen:function[=param]
+	size_t colon = message.find(':');
+	char *end = NULL;
+	long id = std::strtol(message.c_str(), &end, 10);
+	if ((colon == std::string::npos) || (colon == 0) ||
+		(end != message.c_str() + colon)) {
+		reply = "{\"status\":\"error\",\"error\":\"invalid command\"}";
 		return;
 	}
 
@@ -168,32 +178,51 @@ static void wm::process_message()
 			break;
 		}
 	}
-	if (!screen) return;
-
-	std::string wmfunction;
-	if (!std::getline(iss, wmfunction, '='))
+	if (!screen) {
+		reply = "{\"status\":\"error\",\"error\":\"unknown screen\"}";
 		return;
+	}
 
+	size_t equal = message.find('=', colon);
+	std::string_view wmfunction = std::string_view(message).substr(colon + 1,
+		(equal == std::string::npos) ? std::string::npos : equal - colon - 1);
+
+	// The parameter is a decimal or 0x prefixed hexadecimal number
 	long param = 0;
-	std::string wmparam;
-	if (std::getline(iss, wmparam, ';')) {
-		param = std::stol(wmparam);
+	if (equal != std::string::npos) {
+		const char *start = message.c_str() + equal + 1;
+		int base = ((start[0] == '0') && ((start[1] == 'x') ||
+				(start[1] == 'X'))) ? 16 : 10;
+		param = std::strtol(start, &end, base);
+		if ((end == start) || *end) {
+			reply = "{\"status\":\"error\",\"error\":\"invalid parameter\"}";
+			return;
+		}
 	}
 
-	// Look if the wm function is defined and execute if found
-	for (wmfunc::FuncDef &funcdef : wmfunc::funcdefs) {
-		// Only screen functions will be performed
-		if ((funcdef.context == Context::Root) &&
-			!wmfunction.compare(funcdef.namefunc)) {
-			if (funcdef.param == wmfunc::free_param) {
-				(*funcdef.fscreen)(screen, param);
-			} else {
-				(*funcdef.fscreen)(screen, funcdef.param);
-			}
-			XFlush(display);
-			break;
-		}
+	if (query::run(screen, wmfunction,
+			(equal != std::string::npos) ? &param : NULL, reply))
+		return;
+
+	// Look if the wm function is defined and execute if found.
+	// Only screen functions will be performed.
+	const wmfunc::FuncDef *funcdef = wmfunc::find_function(wmfunction);
+	if (funcdef && (funcdef->context == Context::Root)) {
+		if (funcdef->param == wmfunc::free_param)
+			(*funcdef->fscreen)(screen, param);
+		else
+			(*funcdef->fscreen)(screen, funcdef->param);
+		reply = "{\"status\":\"ok\"}";
+		return;
 	}
+	reply = "{\"status\":\"error\",\"error\":\"unknown function\"}";
+}
+
+// State of every screen, sent to a new panel or subscriber
+static void wm::get_snapshot(std::string &messages)
+{
+	for (XScreen *screen : screenlist)
+		screen->write_snapshot(messages);
 }
 
 static void wm::wm_startup()
@@ -216,6 +245,9 @@ static void wm::wm_startup()
 
 	int n;
 	xrandr = XRRQueryExtension(display, &xrandr_event_base, &n);
+	int major, minor;
+	xsync = XSyncQueryExtension(display, &xsync_event_base, &n) &&
+		XSyncInitialize(display, &major, &minor);
 
 	cursors[Pointer::ShapeNormal] = XCreateFontCursor(display, XC_left_ptr);
 	cursors[Pointer::ShapeMove] = XCreateFontCursor(display, XC_fleur);
@@ -230,6 +262,7 @@ static void wm::wm_startup()
 
 	wmh::setup();
 	ewmh::setup();
+	bindtable::build();
 
 	for (int i = 0; i < ScreenCount(display); i++)
 		screenlist.push_back(new XScreen(i));
@@ -257,7 +290,31 @@ static void wm::wm_shutdown()
 	XSetInputFocus(display, PointerRoot, RevertToPointerRoot, CurrentTime);
 	XCloseDisplay(display);
 
+	socket_in::clear();
 	socket_out::clear();
+	if (conf::debug) {
+		evloop::print_stats();
+		XEvents::print_stats();
+		socket_in::Stats istats = socket_in::get_stats();
+		std::cout << timer::gettime() << " [wm::" << __func__ << "] "
+			<< std::dec << istats.commands << " commands received on "
+			<< istats.accepted << " connections, "
+			<< istats.rejected << " rejected, "
+			<< istats.transactions << " transactions, "
+			<< istats.dropped << " events dropped\n";
+		xpointer::Stats pstats = xpointer::get_stats();
+		std::cout << timer::gettime() << " [wm::" << __func__ << "] "
+			<< std::dec << pstats.queries << " pointer queries, "
+			<< pstats.hits << " cached positions used\n";
+		socket_out::Stats sstats = socket_out::get_stats();
+		std::cout << timer::gettime() << " [wm::" << __func__ << "] "
+			<< std::dec << sstats.sent << " messages sent, "
+			<< sstats.dropped << " dropped\n";
+		std::cout << timer::gettime() << " [wm::" << __func__ << "] "
+			<< std::dec << bindtable::unmatched_keys << " unmatched keys, "
+			<< bindtable::unmatched_buttons << " unmatched buttons, "
+			<< XClient::get_writes_suppressed() << " writes suppressed\n";
+	}
 }
 
 static int  wm::start_error_handler(Display *, XErrorEvent *)
@@ -37,6 +37,8 @@ namespace wm {
 	extern volatile sig_atomic_t 		 status;
 	extern int				 xrandr;
 	extern int				 xrandr_event_base;
+	extern int				 xsync;
+	extern int				 xsync_event_base;
 	extern std::vector<Cursor> 		 cursors;
 	extern std::vector<XScreen*>		 screenlist;
 	extern const std::vector<unsigned int>	 ignore_mods;
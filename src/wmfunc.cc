@@ -20,7 +20,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <csignal>
+#include <iterator>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -33,9 +35,9 @@
 #include "wmfunc.h"
 
 namespace wmfunc {
-const long free_param = 99999;
-
-std::vector<FuncDef> funcdefs = {
+// Sorted by name for the binary search in find_function()
+constexpr FuncDef funcdefs[] = {
+	{ "activate-client", 		activate_client, free_param},
 	{ "desktop-close", 		desktop_close},
 	{ "desktop-hide", 		desktop_hide},
 	{ "desktop-layout-1", 		desktop_select_layout, 0},
@@ -50,6 +52,7 @@ std::vector<FuncDef> funcdefs = {
 	{ "desktop-layout-next", 	desktop_rotate_layout, 1},
 	{ "desktop-layout-prev", 	desktop_rotate_layout, -1},
 	{ "desktop-switch-1", 		desktop_switch, 0},
+	{ "desktop-switch-10", 		desktop_switch, 9},
 	{ "desktop-switch-2", 		desktop_switch, 1},
 	{ "desktop-switch-3", 		desktop_switch, 2},
 	{ "desktop-switch-4", 		desktop_switch, 3},
@@ -58,25 +61,31 @@ std::vector<FuncDef> funcdefs = {
 	{ "desktop-switch-7", 		desktop_switch, 6},
 	{ "desktop-switch-8", 		desktop_switch, 7},
 	{ "desktop-switch-9", 		desktop_switch, 8},
-	{ "desktop-switch-10", 		desktop_switch, 9},
 	{ "desktop-switch-last", 	desktop_switch_last},
 	{ "desktop-switch-next", 	desktop_cycle, 1},
 	{ "desktop-switch-prev", 	desktop_cycle, -1},
-	{ "activate-client", 		activate_client, free_param},
 	{ "desktop-window-focus-next", 	desktop_window_cycle, 1},
 	{ "desktop-window-focus-prev", 	desktop_window_cycle, -1},
+	{ "desktop-window-master-decr",	desktop_master_resize, -1},
+	{ "desktop-window-master-incr",	desktop_master_resize, 1},
 	{ "desktop-window-rotate-next",	desktop_rotate_tiles, 1},
 	{ "desktop-window-rotate-prev",	desktop_rotate_tiles, -1},
 	{ "desktop-window-swap-next", 	desktop_swap_tiles, 1},
 	{ "desktop-window-swap-prev", 	desktop_swap_tiles, -1},
-	{ "desktop-window-master-incr",	desktop_master_resize, 1},
-	{ "desktop-window-master-decr",	desktop_master_resize, -1},
-
-	{ "window-lower", 		window_lower},
-	{ "window-hide", 		window_hide},
-	{ "window-raise", 		window_raise},
+	{ "exec", 			exec_cmd},
+	{ "quit", 			set_wm_status, IsQuitting},
+	{ "restart", 			set_wm_status, IsRestarting},
+	{ "terminal", 			exec_term},
 	{ "window-close", 		window_close},
+	{ "window-hide", 		window_hide},
+	{ "window-lower", 		window_lower},
+	{ "window-move", 		window_move, Direction::Pointer},
+	{ "window-move-down", 		window_move, Direction::South},
+	{ "window-move-left", 		window_move, Direction::West},
+	{ "window-move-outline", 	window_outline, DragMove},
+	{ "window-move-right", 		window_move, Direction::East},
 	{ "window-move-to-desktop-1", 	window_to_desktop, 0},
+	{ "window-move-to-desktop-10", 	window_to_desktop, 9},
 	{ "window-move-to-desktop-2", 	window_to_desktop, 1},
 	{ "window-move-to-desktop-3", 	window_to_desktop, 2},
 	{ "window-move-to-desktop-4", 	window_to_desktop, 3},
@@ -85,36 +94,49 @@ std::vector<FuncDef> funcdefs = {
 	{ "window-move-to-desktop-7", 	window_to_desktop, 6},
 	{ "window-move-to-desktop-8", 	window_to_desktop, 7},
 	{ "window-move-to-desktop-9", 	window_to_desktop, 8},
-	{ "window-move-to-desktop-10", 	window_to_desktop, 9},
-	{ "window-snap-up", 		window_snap, Direction::North},
-	{ "window-snap-down", 		window_snap, Direction::South},
-	{ "window-snap-right", 		window_snap, Direction::East},
-	{ "window-snap-left", 		window_snap, Direction::West},
-	{ "window-move", 		window_move, Direction::Pointer},
 	{ "window-move-up", 		window_move, Direction::North},
-	{ "window-move-down", 		window_move, Direction::South},
-	{ "window-move-right", 		window_move, Direction::East},
-	{ "window-move-left", 		window_move, Direction::West},
+	{ "window-raise", 		window_raise},
 	{ "window-resize", 		window_resize, Direction::Pointer},
-	{ "window-resize-up", 		window_resize, Direction::North},
 	{ "window-resize-down", 	window_resize, Direction::South},
-	{ "window-resize-right", 	window_resize, Direction::East},
 	{ "window-resize-left", 	window_resize, Direction::West},
+	{ "window-resize-outline", 	window_outline, DragResize},
+	{ "window-resize-right", 	window_resize, Direction::East},
+	{ "window-resize-up", 		window_resize, Direction::North},
+	{ "window-snap-down", 		window_snap, Direction::South},
+	{ "window-snap-left", 		window_snap, Direction::West},
+	{ "window-snap-right", 		window_snap, Direction::East},
+	{ "window-snap-up", 		window_snap, Direction::North},
 	{ "window-toggle-fullscreen", 	window_state, State::FullScreen},
 	{ "window-toggle-sticky", 	window_state, State::Sticky},
 	{ "window-toggle-tiled", 	window_state, State::NoTile},
-
-	{ "terminal", 			exec_term},
-	{ "restart", 			set_wm_status, IsRestarting},
-	{ "quit", 			set_wm_status, IsQuitting},
-	{ "exec", 			exec_cmd},
 };
+
+constexpr bool is_sorted(const FuncDef *defs, size_t n)
+{
+	for (size_t i = 1; i < n; i++)
+		if (defs[i-1].namefunc >= defs[i].namefunc) return false;
+	return true;
+}
+static_assert(is_sorted(funcdefs, std::size(funcdefs)),
+		"wmfunc::funcdefs must be sorted by name");
+}
+
+// Find a function by name. Return NULL if it is not defined.
+const wmfunc::FuncDef *wmfunc::find_function(std::string_view name)
+{
+	auto it = std::lower_bound(std::begin(funcdefs), std::end(funcdefs), name,
+			[](const FuncDef &def, std::string_view n) {
+				return def.namefunc < n;
+			});
+	if ((it == std::end(funcdefs)) || (it->namefunc != name))
+		return NULL;
+	return it;
 }
 
 void wmfunc::window_move(XClient *client, long direction)
 {
 	if (direction == Direction::Pointer)
-		client->move_window_with_pointer();
+		client->move_window_with_pointer(false);
 	else
 		client->move_window_with_keyboard(direction);
 }
@@ -122,11 +144,19 @@ void wmfunc::window_move(XClient *client, long direction)
 void wmfunc::window_resize(XClient *client, long direction)
 {
 	if (direction == Direction::Pointer)
-		client->resize_window_with_pointer();
+		client->resize_window_with_pointer(false);
 	else
 		client->resize_window_with_keyboard(direction);
 }
 
+void wmfunc::window_outline(XClient *client, long mode)
+{
+	if (mode == DragMove)
+		client->move_window_with_pointer(true);
+	else
+		client->resize_window_with_pointer(true);
+}
+
 void wmfunc::window_snap(XClient *client, long direction)
 {
 	client->snap_window(direction);
@@ -22,18 +22,18 @@
 
 #ifndef _WMFUNC_H_
 #define _WMFUNC_H_
-#include <vector>
 #include <string>
+#include <string_view>
 #include "enums.h"
 
 class XClient;
 class XScreen;
 
 namespace wmfunc {
-	extern const long free_param;
+	constexpr long free_param = 99999;
 
 	struct FuncDef {
-		std::string 		namefunc;
+		std::string_view	namefunc;
 		union {
 			void		(*fcall)(long);
 			void		(*flaunch)(std::string&);
@@ -43,28 +43,29 @@ namespace wmfunc {
 		};
 		Context			context;
 		long			param;
-		FuncDef(const char *n, void (*f)(XScreen *), Context c)
-			:namefunc(n), froot(f), context(c) {}
-		FuncDef(const char *n, void (*f)(long))
-			:namefunc(n), fcall(f), param(0) { context = Context::FuncCall; }
-		FuncDef(const char *n, void (*f)(long), long v)
-			:namefunc(n), fcall(f), param(v) { context = Context::FuncCall; }
-		FuncDef(const char *n, void (*f)(XClient *, long))
-			:namefunc(n), fclient(f), param(0) { context = Context::Window; }
-		FuncDef(const char *n, void (*f)(XClient *, long), long v)
-			:namefunc(n), fclient(f), param(v) { context = Context::Window; }
-		FuncDef(const char *n, void (*f)(XScreen *, long))
-			:namefunc(n), fscreen(f), param(0) { context = Context::Root; }
-		FuncDef(const char *n, void (*f)(XScreen *, long), long v)
-			:namefunc(n), fscreen(f), param(v) { context = Context::Root; }
-		FuncDef(const char *n, void (*f)(std::string&))
-			:namefunc(n), flaunch(f) { context = Context::Launcher; }
+		constexpr FuncDef(const char *n, void (*f)(XScreen *), Context c)
+			:namefunc(n), froot(f), context(c), param(0) {}
+		constexpr FuncDef(const char *n, void (*f)(long))
+			:namefunc(n), fcall(f), context(Context::FuncCall), param(0) {}
+		constexpr FuncDef(const char *n, void (*f)(long), long v)
+			:namefunc(n), fcall(f), context(Context::FuncCall), param(v) {}
+		constexpr FuncDef(const char *n, void (*f)(XClient *, long))
+			:namefunc(n), fclient(f), context(Context::Window), param(0) {}
+		constexpr FuncDef(const char *n, void (*f)(XClient *, long), long v)
+			:namefunc(n), fclient(f), context(Context::Window), param(v) {}
+		constexpr FuncDef(const char *n, void (*f)(XScreen *, long))
+			:namefunc(n), fscreen(f), context(Context::Root), param(0) {}
+		constexpr FuncDef(const char *n, void (*f)(XScreen *, long), long v)
+			:namefunc(n), fscreen(f), context(Context::Root), param(v) {}
+		constexpr FuncDef(const char *n, void (*f)(std::string&))
+			:namefunc(n), flaunch(f), context(Context::Launcher), param(0) {}
 	};
 
-	extern std::vector<FuncDef> funcdefs;
+	const FuncDef *find_function(std::string_view);
 	void window_resize(XClient *, long);
 	void window_move(XClient *, long);
 	void window_resize(XClient *, long);
+	void window_outline(XClient *, long);
 	void window_snap(XClient *, long);
 	void window_close(XClient *, long);
 	void window_lower(XClient *, long);
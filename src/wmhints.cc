@@ -22,6 +22,7 @@
 
 #include <X11/Xatom.h>
 #include <X11/Xlib.h>
+#include <cstring>
 #include <string>
 #include <vector>
 #include "config.h"
@@ -89,14 +90,21 @@ void wmh::send_client_message(Window win, Atom proto, Time ts)
 int wmh::get_text_property(Window window, Atom atom, std::vector<char>& text)
 {
 	XTextProperty	 prop;
-	char		**textlist;
-	int		 nitems = 0, len;
+	int		 nitems = 0;
 
 	XGetTextProperty(wm::display, window, &prop, atom);
-	if (!prop.nitems) {
-		XFree(prop.value);
-		return 0;
-	}
+	if (prop.nitems)
+		nitems = convert_text_property(prop, text);
+	XFree(prop.value);
+
+	return nitems;
+}
+
+// Convert a text property to a single UTF-8 string.
+int wmh::convert_text_property(XTextProperty &prop, std::vector<char>& text)
+{
+	char		**textlist;
+	int		 nitems = 0, len;
 
 	if (Xutf8TextPropertyToTextList(wm::display, &prop, &textlist, &nitems) == Success) {
 		if ((nitems == 1) && (*textlist)) {
@@ -115,7 +123,6 @@ int wmh::get_text_property(Window window, Atom atom, std::vector<char>& text)
 		}
 		if (*textlist) XFreeStringList(textlist);
 	}
-	XFree(prop.value);
 
 	return nitems;
 }
@@ -172,6 +179,8 @@ void ewmh::setup()
 	defs[_NET_WM_NAME] 			= "_NET_WM_NAME";
 	defs[_NET_WM_DESKTOP] 			= "_NET_WM_DESKTOP";
 	defs[_NET_CLOSE_WINDOW] 		= "_NET_CLOSE_WINDOW";
+	defs[_NET_WM_SYNC_REQUEST] 		= "_NET_WM_SYNC_REQUEST";
+	defs[_NET_WM_SYNC_REQUEST_COUNTER] 	= "_NET_WM_SYNC_REQUEST_COUNTER";
 	defs[_NET_WM_WINDOW_TYPE] 		= "_NET_WM_WINDOW_TYPE";
 	defs[_NET_WM_WINDOW_TYPE_DIALOG] 	= "_NET_WM_WINDOW_TYPE_DIALOG";
 	defs[_NET_WM_WINDOW_TYPE_DOCK] 		= "_NET_WM_WINDOW_TYPE_DOCK";
@@ -243,20 +252,23 @@ void ewmh::set_net_workarea(Window rootwin, int ndesktops, Geometry &work)
 
 void ewmh::set_net_client_list(Window rootwin, std::vector<Window> &winlist)
 {
-	int nwins = winlist.size();
-	if (nwins == 0) return;
+	XChangeProperty(wm::display, rootwin, hints[_NET_CLIENT_LIST], XA_WINDOW, 32,
+			PropModeReplace, (unsigned char *)winlist.data(), winlist.size());
+}
 
+// Append the windows of the list from index start
+void ewmh::append_net_client_list(Window rootwin, std::vector<Window> &winlist,
+					size_t start)
+{
 	XChangeProperty(wm::display, rootwin, hints[_NET_CLIENT_LIST], XA_WINDOW, 32,
-			PropModeReplace, (unsigned char *)winlist.data(), nwins);
+			PropModeAppend, (unsigned char *)(winlist.data() + start),
+			winlist.size() - start);
 }
 
 void ewmh::set_net_client_list_stacking(Window rootwin, std::vector<Window> &winlist)
 {
-	int nwins = winlist.size();
-	if (nwins == 0) return;
-
 	XChangeProperty(wm::display, rootwin, hints[_NET_CLIENT_LIST_STACKING], XA_WINDOW, 32,
-			PropModeReplace, (unsigned char *)winlist.data(), nwins);
+			PropModeReplace, (unsigned char *)winlist.data(), winlist.size());
 }
 
 void ewmh::set_net_active_window(Window rootwin, Window active)
@@ -405,9 +417,14 @@ int ewmh::get_net_wm_state_atoms(Window window, std::vector<Atom> &atoms)
 
 long ewmh::get_net_wm_states(Window window, long initial)
 {
-	long states = initial;
 	std::vector<Atom> atoms;
 	get_net_wm_state_atoms(window, atoms);
+	return get_net_wm_states(atoms, initial);
+}
+
+long ewmh::get_net_wm_states(std::vector<Atom> &atoms, long initial)
+{
+	long states = initial;
 	for (Atom atom : atoms)
 		for (StateMap &sm : statemaps)
 			if (atom == hints[sm.atom]) {
@@ -417,6 +434,15 @@ long ewmh::get_net_wm_states(Window window, long initial)
 	return states;
 }
 
+// States that are reflected in _NET_WM_STATE
+long ewmh::get_net_wm_state_mask()
+{
+	long mask = 0;
+	for (StateMap &sm : statemaps)
+		mask |= sm.state;
+	return mask;
+}
+
 void ewmh::set_net_wm_states(Window window, long states)
 {
 	std::vector<Atom> current_atoms;
@@ -446,3 +472,38 @@ void ewmh::set_net_wm_states(Window window, long states)
 		XDeleteProperty(wm::display, window, hints[_NET_WM_STATE]);
 	}
 }
+
+// Counter updated by the client after a sync request, or None
+XID ewmh::get_net_wm_sync_request_counter(Window window)
+{
+	unsigned long	 n;
+	long		*prop;
+	XID		 counter = None;
+
+	prop = (long *)wmh::get_window_property(window,
+			hints[_NET_WM_SYNC_REQUEST_COUNTER], XA_CARDINAL, 2L, &n);
+	if (prop) {
+		if (n) counter = *prop;
+		XFree((char *)prop);
+	}
+	return counter;
+}
+
+// Ask the client to set its counter to value once it has handled the
+// configure event that follows.
+void ewmh::send_net_wm_sync_request(Window window, int64_t value)
+{
+	XClientMessageEvent	 cm;
+
+	memset(&cm, 0, sizeof(cm));
+	cm.type = ClientMessage;
+	cm.window = window;
+	cm.message_type = wmh::hints[WM_PROTOCOLS];
+	cm.format = 32;
+	cm.data.l[0] = hints[_NET_WM_SYNC_REQUEST];
+	cm.data.l[1] = wm::last_event_time;
+	cm.data.l[2] = value & 0xffffffff;
+	cm.data.l[3] = (value >> 32) & 0xffffffff;
+
+	XSendEvent(wm::display, window, False, NoEventMask, (XEvent *)&cm);
+}
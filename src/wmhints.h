@@ -23,6 +23,7 @@
 #ifndef _WMHINTS_H_
 #define _WMHINTS_H_
 #include <X11/Xlib.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "geometry.h"
@@ -40,6 +41,7 @@ namespace wmh {
 	void 		 set_wm_state(Window window, long wstate);
 	void		 send_client_message(Window, Atom, Time);
 	int		 get_text_property(Window, Atom, std::vector<char>&);
+	int		 convert_text_property(XTextProperty&, std::vector<char>&);
 	void		*get_window_property(Window, Atom, Atom, long, unsigned long *);
 }
 
@@ -53,6 +55,7 @@ namespace ewmh {
 	void		 set_net_desktop_viewport(Window);
 	void		 set_net_workarea(Window, int, Geometry&);
 	void		 set_net_client_list(Window, std::vector<Window>&);
+	void		 append_net_client_list(Window, std::vector<Window>&, size_t);
 	void		 set_net_client_list_stacking(Window, std::vector<Window>&);
 	void		 set_net_active_window(Window, Window);
 	void		 set_net_number_of_desktops(Window, int);
@@ -66,6 +69,10 @@ namespace ewmh {
 	int		 get_net_wm_window_type(Window, std::vector<Atom>&);
 	int		 get_net_wm_state_atoms(Window, std::vector<Atom>&);
 	long		 get_net_wm_states(Window, long);
+	long		 get_net_wm_states(std::vector<Atom>&, long);
+	long		 get_net_wm_state_mask();
 	void		 set_net_wm_states(Window, long);
+	XID		 get_net_wm_sync_request_counter(Window);
+	void		 send_net_wm_sync_request(Window, int64_t);
 }
 #endif // _WMHINTS_H_
@@ -22,27 +22,28 @@
 
 #include <X11/Xatom.h>
 #include <algorithm>
+#include <cstdio>
 #include <iostream>
-#include <regex>
-#include <sstream>
 #include <string>
 #include <vector>
 #include "timer.h"
-#include "socket.h"
+#include "json.h"
+#include "events.h"
 #include "bind.h"
 #include "config.h"
 #include "wmhints.h"
 #include "wmcore.h"
 #include "xpointer.h"
 #include "xscreen.h"
-#include "xwinprop.h"
+#include "xdrag.h"
+#include "xquery.h"
 #include "xclient.h"
 
-const long XClient::MouseMask	= ButtonReleaseMask|PointerMotionMask;
+unsigned long XClient::s_writes_suppressed = 0;
 
-XClient::XClient(Window w, XScreen *s, bool existing): m_window(w), m_screen(s)
+XClient::XClient(XQuery &query, XScreen *s, bool existing):
+	m_window(query.get_window()), m_screen(s)
 {
-	XWindowAttributes	 wattr;
 	m_removed = false;
 
 	if (conf::debug) {
@@ -54,29 +55,35 @@ XClient::XClient(Window w, XScreen *s, bool existing): m_window(w), m_screen(s)
 	m_rootwin = m_screen->get_window();
 	m_border_w = conf::stacked_border;
 	m_parent = None;
+	m_mapped = false;
+	m_pixel_applied = 0;
+	m_net_states_applied = -1;
+	m_wm_state_applied = -1;
 	m_states = 0;
 	m_initial_state = 0;
 
-	// Disable processing of X requests
-	XGrabServer(wm::display);
-
-	// Get window informations
-	XGetWindowAttributes(wm::display, m_window, &wattr);
-	m_geom.x = wattr.x;
-	m_geom.y = wattr.y;
-	m_geom.w = wattr.width;
-	m_geom.h = wattr.height;
-	m_colormap = wattr.colormap;
-	m_border_orig = wattr.border_width;
-
-	get_net_wm_name();		// Get window name
-	get_net_wm_window_type();	// Get window type
-	get_wm_hints();			// Get input, urgency and initial status hints
-	get_class_hint();		// Get class and name hint
-	get_wm_protocols();		// Get wm defined protocols.
-	get_wm_normal_hints();		// Get hints from the window geometry
-	get_transient();		// Set transient windows to ignore
-	get_motif_hints();		// Check if window wants no border
+	// Window informations were all requested by the query
+	query.fetch();
+	m_geom.x = query.x;
+	m_geom.y = query.y;
+	m_geom.w = query.w;
+	m_geom.h = query.h;
+	m_colormap = query.colormap;
+	m_border_orig = query.border_width;
+
+	m_name = query.name;
+	m_res_class = query.res_class;
+	m_res_name = query.res_name;
+	m_hints = SizeHints(query.normal_hints);
+
+	set_net_wm_window_type(query.window_type);
+	if (query.has_wm_hints)
+		set_wm_hints(query.wm_hints);
+	set_wm_protocols(query.protocols);
+	m_sync_counter = query.sync_counter;
+	set_transient(query.transient_for);
+	if (query.has_motif_hints)
+		set_motif_hints(query.motif_hints);
 
 	apply_user_states();	// Apply user configured states
 
@@ -87,29 +94,31 @@ XClient::XClient(Window w, XScreen *s, bool existing): m_window(w), m_screen(s)
 	m_ptr = m_geom.get_center(Coordinates::Window);
 
 	// New window starts as hidden until reparent
-	if (wattr.map_state != IsViewable) {
+	if (query.map_state != IsViewable) {
 		set_initial_placement();
-		wmh::set_wm_state(m_window, IconicState);
+		set_wm_state(IconicState);
 	}
 	m_geom_stack = m_geom;
 
-	XSelectInput(wm::display, m_window, PropertyChangeMask);
-
 	send_configure_event();
-	m_states = ewmh::get_net_wm_states(m_window, m_states);
+	m_states = ewmh::get_net_wm_states(query.net_wm_state, m_states);
 
 	// Set the desktop index.
-	if (!existing) m_deskindex = get_configured_desktop();
-	else m_deskindex = get_net_wm_desktop();
+	m_deskindex = -1;
+	if (!existing)
+		m_deskindex = get_configured_desktop();
+	else if (query.has_net_wm_desktop)
+		m_deskindex = std::min(query.net_wm_desktop,
+					(m_screen->get_num_desktops() - 1));
 	if ((m_deskindex == -1) && !has_state(State::Sticky))
 		m_deskindex = m_screen->get_active_desktop();
 	ewmh::set_net_wm_desktop(m_window, m_deskindex);
 
+	// Only the reparenting needs the server grabbed. Existing windows
+	// are adopted while the screen holds the grab.
+	if (!existing) XGrabServer(wm::display);
 	reparent_window();
-
-	// Resume processing of X requests
-	XSync(wm::display, False);
-	XUngrabServer(wm::display);
+	if (!existing) XUngrabServer(wm::display);
 }
 
 XClient::~XClient()
@@ -120,6 +129,8 @@ XClient::~XClient()
 			<< std::endl;
 	}
 
+	xdrag::cancel(this);
+
 	// Disable processing of X requests
 	XGrabServer(wm::display);
 	XUngrabButton(wm::display, AnyButton, AnyModifier, m_parent);
@@ -169,6 +180,9 @@ void XClient::reparent_window()
 			DefaultVisual(wm::display, m_screen->get_screenid()),
 			CWOverrideRedirect|CWBorderPixel|CWEventMask, &wattr);
 
+	m_geom_applied = m_geom;
+	m_border_applied = m_border_w;
+
 	XAddToSaveSet(wm::display, m_window);
 	XSetWindowBorderWidth(wm::display, m_window, 0);
 	XReparentWindow(wm::display, m_window, m_parent, 0, 0);
@@ -202,8 +216,41 @@ void XClient::draw_window_border()
 	else
 		pixel = m_screen->get_pixel(Color::WindowBorderInactive);
 
-	XSetWindowBorderWidth(wm::display, m_parent, m_border_w);
-	XSetWindowBorder(wm::display, m_parent, pixel | (0xffu << 24));
+	pixel |= (0xffu << 24);
+	if (m_border_w != m_border_applied) {
+		XSetWindowBorderWidth(wm::display, m_parent, m_border_w);
+		m_border_applied = m_border_w;
+	} else
+		s_writes_suppressed++;
+	if (pixel != m_pixel_applied) {
+		XSetWindowBorder(wm::display, m_parent, pixel);
+		m_pixel_applied = pixel;
+	} else
+		s_writes_suppressed++;
+}
+
+// Write the EWMH states of the client if they changed since last written.
+void XClient::set_net_wm_states()
+{
+	long states = m_states & ewmh::get_net_wm_state_mask();
+	m_screen->set_state_dirty();
+	if (states == m_net_states_applied) {
+		s_writes_suppressed++;
+		return;
+	}
+	ewmh::set_net_wm_states(m_window, m_states);
+	m_net_states_applied = states;
+}
+
+void XClient::set_wm_state(long state)
+{
+	m_screen->set_state_dirty();
+	if (state == m_wm_state_applied) {
+		s_writes_suppressed++;
+		return;
+	}
+	wmh::set_wm_state(m_window, state);
+	m_wm_state_applied = state;
 }
 
 bool XClient::has_window(Window w)
@@ -226,28 +273,45 @@ void XClient::get_net_wm_name()
 void XClient::update_net_wm_name()
 {
 	get_net_wm_name();
-	panel_update_title();
+	if (has_state(State::Active))
+		panel_update_title();
 	m_screen->panel_update_client_list();
 }
 
+// The title is sent by the screen at the end of the event loop iteration
 void XClient::panel_update_title()
 {
-	if (!socket_out::defined()) return;
-	std::stringstream ss;
-	ss << "\"window\":\"" << m_window << "\",";
-	ss << "\"desknum\":\"" << m_deskindex+1 << "\",";
-	std::string str = m_name;
-	str = std::regex_replace(str, std::regex("\\\\"), "\\$&");
-	str = std::regex_replace(str, std::regex("\""), "\\$&");
-	ss << "\"name\":\"" + str + "\"";
-	std::string message = "{\"active_window\":{" + ss.str() + "}}";
-	socket_out::send(message);
+	m_screen->panel_update_title(m_window);
 }
 
-void XClient::get_net_wm_window_type()
+void XClient::send_title()
+{
+	if (!events::wanted(TopicFocus|TopicTitle)) return;
+	static std::string message;
+	JsonWriter json(message);
+	json.begin_object().key("active_window").begin_object()
+		.key("window").quoted(m_window)
+		.key("desknum").quoted(m_deskindex+1)
+		.key("name").value(m_name)
+		.end_object().end_object();
+	events::publish(TopicFocus|TopicTitle, message);
+}
+
+void XClient::panel_update_geometry()
+{
+	if (!events::wanted(TopicGeometry)) return;
+	static std::string message;
+	JsonWriter json(message);
+	json.begin_object().key("client_geometry").begin_object()
+		.key("window").quoted(m_window)
+		.key("x").value(m_geom.x).key("y").value(m_geom.y)
+		.key("w").value(m_geom.w).key("h").value(m_geom.h)
+		.end_object().end_object();
+	events::publish(TopicGeometry, message);
+}
+
+void XClient::set_net_wm_window_type(std::vector<Atom> &atoms)
 {
-	std::vector<Atom> atoms;
-	ewmh::get_net_wm_window_type(m_window, atoms);
 	for (Atom atom : atoms) {
 		if (atom == ewmh::hints[_NET_WM_WINDOW_TYPE_DOCK]) {
 			set_states(State::Docked);
@@ -272,97 +336,73 @@ void XClient::get_net_wm_window_type()
 	}
 }
 
-void XClient::get_class_hint()
+void XClient::get_wm_hints()
 {
-	XClassHint	hint;
+	XWMHints	*wmh;
 
-	if (XGetClassHint(wm::display, m_window, &hint)) {
-		if (hint.res_class) {
-			m_res_class = hint.res_class;
-			XFree(hint.res_class);
-		}
-		if (hint.res_name) {
-			m_res_name = hint.res_name;
-			XFree(hint.res_name);
-		}
+	if ((wmh = XGetWMHints(wm::display, m_window)) != NULL) {
+		set_wm_hints(*wmh);
+		XFree(wmh);
 	}
 }
 
-long XClient::get_net_wm_desktop()
+void XClient::set_wm_hints(XWMHints &wmh)
 {
-	long	index = -1;
-	if (ewmh::get_net_wm_desktop(m_window, &index)) {
-		index = std::min(index, (m_screen->get_num_desktops() - 1));
-	}
-	return index;
+	if ((wmh.flags & InputHint) && (wmh.input))
+		set_states(State::Input);
+	if ((wmh.flags & XUrgencyHint))
+		set_states(State::Urgent);
+	if ((wmh.flags & StateHint))
+		m_initial_state = wmh.initial_state;
 }
 
-void XClient::get_wm_hints()
+void XClient::set_wm_protocols(std::vector<Atom> &protocols)
 {
-	XWMHints	*wmh;
-
-	if ((wmh = XGetWMHints(wm::display, m_window)) != NULL) {
-		if ((wmh->flags & InputHint) && (wmh->input))
-			set_states(State::Input);
-		if ((wmh->flags & XUrgencyHint))
-			set_states(State::Urgent);
-		if ((wmh->flags & StateHint))
-			m_initial_state = wmh->initial_state;
-		XFree(wmh);
+	for (Atom protocol : protocols) {
+		if (protocol == wmh::hints[WM_DELETE_WINDOW])
+			set_states(State::WMDeleteWindow);
+		else if (protocol == wmh::hints[WM_TAKE_FOCUS])
+			set_states(State::WMTakeFocus);
+		else if (protocol == ewmh::hints[_NET_WM_SYNC_REQUEST])
+			set_states(State::WMSyncRequest);
 	}
 }
 
-void XClient::get_wm_protocols()
+void XClient::update_sync_counter()
 {
-	Atom	*protocol;
-	int	 i, n;
+	m_sync_counter = ewmh::get_net_wm_sync_request_counter(m_window);
+}
 
-	if (XGetWMProtocols(wm::display, m_window, &protocol, &n)) {
-		for (i = 0; i < n; i++) {
-			if (protocol[i] == wmh::hints[WM_DELETE_WINDOW])
-				set_states(State::WMDeleteWindow);
-			else if (protocol[i] == wmh::hints[WM_TAKE_FOCUS])
-				set_states(State::WMTakeFocus);
-		}
-		XFree(protocol);
-	}
+void XClient::get_transient()
+{
+	Window		 trans;
+
+	if (XGetTransientForHint(wm::display, m_window, &trans))
+		set_transient(trans);
 }
 
 // Set transient window state to ignored
-void XClient::get_transient()
+void XClient::set_transient(Window trans)
 {
 	XClient		*tc;
-	Window		 trans;
 
-	if (XGetTransientForHint(wm::display, m_window, &trans)) {
-		if ((tc = XScreen::find_client(trans)) != NULL) {
-			if (tc->has_state(State::Ignored)) {
-				set_states(State::NoTile|State::Ignored);
-				m_border_w = tc->m_border_w;
-			}
+	if ((tc = XScreen::find_client(trans)) != NULL) {
+		if (tc->has_state(State::Ignored)) {
+			set_states(State::NoTile|State::Ignored);
+			m_border_w = tc->m_border_w;
 		}
 	}
 }
 
 // Some windows will signal they want no border through Motif hints
-void XClient::get_motif_hints()
+void XClient::set_motif_hints(MotifHints &hints)
 {
-	unsigned long	 n;
-	MotifHints	*hints;
-
-	hints = (MotifHints *)wmh::get_window_property(m_window,
-						wmh::hints[_MOTIF_WM_HINTS],
-						wmh::hints[_MOTIF_WM_HINTS],
-						Motif::HintElements, &n);
-	if (!hints) return;
-
-	if ((hints->flags & Motif::HintDecorations) &&
-		!(hints->decorations & Motif::DecorAll)) {
-		if (!(hints->decorations & Motif::DecorBorder)) {
+	if ((hints.flags & Motif::HintDecorations) &&
+		!(hints.decorations & Motif::DecorAll)) {
+		if (!(hints.decorations & Motif::DecorBorder)) {
 			set_states(State::NoTile|State::NoBorder);
 		}
 	}
-	XFree(hints);
 }
 
 // Calculate initial placement of the window
@@ -476,10 +516,11 @@ void XClient::set_window_active()
 	else if (has_state(State::WMTakeFocus))
 		wmh::send_client_message(m_window, wmh::hints[WM_TAKE_FOCUS],
 						wm::last_event_time);
-	ewmh::set_net_active_window(m_rootwin, m_window);
+	m_screen->set_net_active_window(m_window);
 	XInstallColormap(wm::display, m_colormap);
 
 	set_states(State::Active);
+	XScreen::update_active_client(this, true);
 	clear_states(State::Urgent);
 	draw_window_border();
 	if (!has_state(State::Tiled))
@@ -499,31 +540,42 @@ void XClient::set_window_inactive()
 	}
 
 	clear_states(State::Active);
+	XScreen::update_active_client(this, false);
 	draw_window_border();
 	XSetInputFocus(wm::display, PointerRoot, RevertToPointerRoot, CurrentTime);
-	ewmh::set_net_active_window(m_rootwin, None);
+	m_screen->set_net_active_window(None);
 }
 
 void XClient::show_window()
 {
 	clear_states(State::Hidden);
-	ewmh::set_net_wm_states(m_window, m_states);
-	wmh::set_wm_state(m_window, NormalState);
-	XMapWindow(wm::display, m_parent);
-	XMapWindow(wm::display, m_window);
+	set_net_wm_states();
+	set_wm_state(NormalState);
+	if (!m_mapped) {
+		XMapWindow(wm::display, m_parent);
+		XMapWindow(wm::display, m_window);
+		m_mapped = true;
+	} else
+		s_writes_suppressed++;
 	draw_window_border();
 }
 
 void XClient::hide_window()
 {
-	XUnmapWindow(wm::display, m_parent);
+	xdrag::cancel(this);
+	if (m_mapped) {
+		XUnmapWindow(wm::display, m_parent);
+		m_mapped = false;
+	} else
+		s_writes_suppressed++;
 	if (has_state(State::Active)) {
 		clear_states(State::Active);
-		ewmh::set_net_active_window(m_rootwin, None);
+		XScreen::update_active_client(this, false);
+		m_screen->set_net_active_window(None);
 	}
 	set_states(State::Hidden);
-	ewmh::set_net_wm_states(m_window, m_states);
-	wmh::set_wm_state(m_window, IconicState);
+	set_net_wm_states();
+	set_wm_state(IconicState);
 }
 
 void XClient::close_window()
@@ -562,17 +614,12 @@ void XClient::move_window_with_keyboard(long direction)
 	move_window();
 	move_pointer_inside();
 	m_geom_stack = m_geom;
-
-	XSync(wm::display, True);
 }
 
-void XClient::move_window_with_pointer()
+// In outline mode, the window is only moved or resized at the end of the
+// drag, and an outline shows its geometry meanwhile.
+void XClient::move_window_with_pointer(bool outline)
 {
-	XEvent		 ev;
-	Time		 ltime = 0;
-	Geometry	 area;
-	Position	 pos;
-
 	if (conf::debug) {
 		std::cout << timer::gettime() << " [XClient::" << __func__
 			<< "] Move window 0x" << std::hex << m_window << std::endl;
@@ -581,53 +628,17 @@ void XClient::move_window_with_pointer()
 
 	raise_window();
 	move_pointer_inside();
-
-	if (XGrabPointer(wm::display, m_parent, False, MouseMask,
-		GrabModeAsync, GrabModeAsync, None, wm::cursors[Pointer::ShapeMove],
-		 CurrentTime) != GrabSuccess) return;
-
-	XWinProp win_prop(m_screen, m_parent);
-	std::string label = std::to_string(m_geom.x) + " . " + std::to_string(m_geom.y);
-	win_prop.draw(label, m_geom.w/2, m_geom.h/2);
-
-	bool buttonpress = true;
-	while (buttonpress) {
-		XMaskEvent(wm::display, MouseMask, &ev);
-		switch (ev.type) {
-		case MotionNotify:
-			// not more than 60 times / second
-			if ((ev.xmotion.time - ltime) <= (1000 / 60))
-				continue;
-			ltime = ev.xmotion.time;
-
-			m_geom.x = ev.xmotion.x_root - m_ptr.x - m_border_w;
-			m_geom.y = ev.xmotion.y_root - m_ptr.y - m_border_w;
-
-			pos = m_geom.get_center(Coordinates::Root);
-			area = m_screen->get_area(pos, true);
-			m_geom.snap_to_edge(area);
-			move_window();
-
-			label = std::to_string(m_geom.x) + " . "
-						+ std::to_string(m_geom.y);
-			win_prop.draw(label, m_geom.w/2, m_geom.h/2);
-
-			break;
-		case ButtonRelease:
-			buttonpress = false;
-			break;
-		}
-	}
-	if (ltime) move_window();
-	XUngrabPointer(wm::display, CurrentTime);
-	m_geom_stack = m_geom;
-	XSync(wm::display, True);
+	outline |= conf::drag_outline || has_state(State::Outline);
+	xdrag::start(this, DragMove, Direction::Pointer,
+			wm::cursors[Pointer::ShapeMove], outline);
 }
 
 void XClient::move_window()
 {
 	XMoveWindow(wm::display, m_parent, m_geom.x, m_geom.y);
+	m_geom_applied.set_pos(m_geom.x, m_geom.y);
 	send_configure_event();
+	panel_update_geometry();
 }
 
 void XClient::resize_window_with_keyboard(long direction)
@@ -638,10 +649,9 @@ void XClient::resize_window_with_keyboard(long direction)
 	resize_window();
 	move_pointer_inside();
 	m_geom_stack = m_geom;
-	XSync(wm::display, True);
 }
 
-void XClient::resize_window_with_pointer()
+void XClient::resize_window_with_pointer(bool outline)
 {
 	if (has_state(State::Frozen|State::NoResize)) return;
 
@@ -650,7 +660,7 @@ void XClient::resize_window_with_pointer()
 	}
 
 	raise_window();
-	m_ptr = xpointer::get_pos(m_parent);
+	m_ptr = get_pointer();
 
 	// Pointer position determines the direction of the resize
 	Direction	direction;
@@ -693,97 +703,135 @@ void XClient::resize_window_with_pointer()
 		cursor = wm::cursors[Pointer::ShapeEast];
 	}
 
-	if (XGrabPointer(wm::display, m_parent, False, MouseMask, GrabModeAsync,
-		GrabModeAsync, None, cursor, CurrentTime) != GrabSuccess) return;
-
-	XWinProp win_prop(m_screen, m_parent);
-	int width = (m_geom.w - m_hints.basew) / m_hints.incw;
-	int height = (m_geom.h - m_hints.baseh) / m_hints.inch;
-	std::string label = std::to_string(width) + " x " + std::to_string(height);
-	win_prop.draw(label, m_geom.w/2, m_geom.h/2);
-
-	XEvent	ev;
-	Time	ltime = 0;
-	bool	buttonpress = true;
-	int	xmax = m_geom.x + m_geom.w;
-	int	ymax = m_geom.y + m_geom.h;
-	while (buttonpress) {
-		XMaskEvent(wm::display, MouseMask, &ev);
-		switch (ev.type) {
-		case MotionNotify:
-			// not more than 60 times / second
-			if ((ev.xmotion.time - ltime) <= (1000 / 60))
-				continue;
-			ltime = ev.xmotion.time;
-			switch(direction) {
-			case Direction::North:
-				m_geom.y = ev.xmotion.y_root;
-				m_geom.h = ymax - m_geom.y;
-				break;
-			case Direction::South:
-				m_geom.h = ev.xmotion.y;
-				break;
-			case Direction::East:
-				m_geom.w = ev.xmotion.x;
-				break;
-			case Direction::West:
-				m_geom.x = ev.xmotion.x_root;
-				m_geom.w = xmax - m_geom.x;
-				break;
-			case Direction::NorthEast:
-				m_geom.w = ev.xmotion.x;
-				m_geom.y = ev.xmotion.y_root;
-				m_geom.h = ymax - m_geom.y;
-				break;
-			case Direction::SouthEast:
-				m_geom.w = ev.xmotion.x;
-				m_geom.h = ev.xmotion.y;
-				break;
-			case Direction::SouthWest:
-				m_geom.x = ev.xmotion.x_root;
-				m_geom.w = xmax - m_geom.x;
-				m_geom.h = ev.xmotion.y;
-				break;
-			case Direction::NorthWest:
-				m_geom.x = ev.xmotion.x_root;
-				m_geom.y = ev.xmotion.y_root;
-				m_geom.w = xmax - m_geom.x;
-				m_geom.h = ymax - m_geom.y;
-				break;
-			default:
-				m_geom.x = ev.xmotion.x_root - m_ptr.x - m_border_w;
-				m_geom.y = ev.xmotion.y_root - m_ptr.y - m_border_w;
-				break;
-			}
-
-			m_geom.apply_size_hints(m_hints);
-			resize_window();
-			m_geom_stack = m_geom;
-
-			width = (m_geom.w - m_hints.basew) / m_hints.incw;
-			height = (m_geom.h - m_hints.baseh) / m_hints.inch;
-			label = std::to_string(width) + " x " + std::to_string(height);
-			win_prop.draw(label, m_geom.w/2, m_geom.h/2);
-			break;
-		case ButtonRelease:
-			buttonpress = false;
-			break;
-		}
+	outline |= conf::drag_outline || has_state(State::Outline);
+	xdrag::start(this, DragResize, direction, cursor, outline);
+}
+
+// New geometry of the window dragged with the pointer, at its position p
+// on the root window. The geometry at the start of the drag gives the
+// corner opposite to the one being dragged.
+void XClient::get_drag_geometry(DragMode mode, long direction, Position p,
+				Geometry &origin, Geometry &geom)
+{
+	int xmax = origin.x + origin.w;
+	int ymax = origin.y + origin.h;
+	int border = m_border_applied;
+	int x = p.x - m_geom_applied.x - border;	// relative to the frame
+	int y = p.y - m_geom_applied.y - border;
+
+	if (mode == DragMove) {
+		geom.x = p.x - m_ptr.x - m_border_w;
+		geom.y = p.y - m_ptr.y - m_border_w;
+
+		Position pos = geom.get_center(Coordinates::Root);
+		Geometry area = m_screen->get_area(pos, true);
+		geom.snap_to_edge(area);
+		return;
+	}
+
+	switch(direction) {
+	case Direction::North:
+		geom.y = p.y;
+		geom.h = ymax - geom.y;
+		break;
+	case Direction::South:
+		geom.h = y;
+		break;
+	case Direction::East:
+		geom.w = x;
+		break;
+	case Direction::West:
+		geom.x = p.x;
+		geom.w = xmax - geom.x;
+		break;
+	case Direction::NorthEast:
+		geom.w = x;
+		geom.y = p.y;
+		geom.h = ymax - geom.y;
+		break;
+	case Direction::SouthEast:
+		geom.w = x;
+		geom.h = y;
+		break;
+	case Direction::SouthWest:
+		geom.x = p.x;
+		geom.w = xmax - geom.x;
+		geom.h = y;
+		break;
+	case Direction::NorthWest:
+		geom.x = p.x;
+		geom.y = p.y;
+		geom.w = xmax - geom.x;
+		geom.h = ymax - geom.y;
+		break;
+	default:
+		geom.x = p.x - m_ptr.x - m_border_w;
+		geom.y = p.y - m_ptr.y - m_border_w;
+		break;
+	}
+
+	geom.apply_size_hints(m_hints);
+}
+
+// Move or resize the window to follow the pointer. If sync is set and the
+// size changes, a sync request for the next counter value is sent before
+// the configure and true is returned.
+bool XClient::drag_window(DragMode mode, long direction, Position p,
+				Geometry &origin, int64_t *sync)
+{
+	get_drag_geometry(mode, direction, p, origin, m_geom);
+	if (mode == DragMove) {
+		move_window();
+		return false;
 	}
-	if (ltime) resize_window();
-	XUngrabPointer(wm::display, CurrentTime);
 
+	bool requested = false;
+	if (sync && ((m_geom.w != m_geom_applied.w) ||
+			(m_geom.h != m_geom_applied.h))) {
+		ewmh::send_net_wm_sync_request(m_window, ++(*sync));
+		requested = true;
+	}
+	resize_window();
+	m_geom_stack = m_geom;
+	return requested;
+}
+
+// Text shown in the window while it is dragged to the given geometry
+void XClient::get_drag_label(DragMode mode, Geometry &geom, char *text,
+				size_t size)
+{
+	if (mode == DragMove) {
+		snprintf(text, size, "%d . %d", geom.x, geom.y);
+		return;
+	}
+	int width = (geom.w - m_hints.basew) / m_hints.incw;
+	int height = (geom.h - m_hints.baseh) / m_hints.inch;
+	snprintf(text, size, "%d x %d", width, height);
+}
+
+void XClient::end_drag(DragMode mode)
+{
+	m_geom_stack = m_geom;
+	if (mode == DragMove) return;
 	// Make sure the pointer stays within the window.
 	move_pointer_inside();
-	XSync(wm::display, True);
 }
 
 void XClient::resize_window()
 {
 	XMoveResizeWindow(wm::display, m_parent, m_geom.x, m_geom.y, m_geom.w, m_geom.h);
 	XMoveResizeWindow(wm::display, m_window, 0, 0, m_geom.w, m_geom.h);
+	m_geom_applied = m_geom;
 	draw_window_border();
 	send_configure_event();
+	panel_update_geometry();
+}
+
+// Configure the window only if its geometry or border has changed.
+void XClient::apply_geometry()
+{
+	if ((m_geom != m_geom_applied) || (m_border_w != m_border_applied))
+		resize_window();
 }
 
 void XClient::snap_window(long direction)
@@ -798,19 +846,19 @@ void XClient::snap_window(long direction)
 
 void XClient::move_pointer_inside()
 {
-	m_ptr = xpointer::get_pos(m_parent);
+	m_ptr = get_pointer();
 	m_ptr.move_inside(m_geom);
-	xpointer::set_pos(m_parent, m_ptr);
+	set_pointer(m_ptr);
 }
 
 void XClient::warp_pointer()
 {
-	xpointer::set_pos(m_parent, m_ptr);
+	set_pointer(m_ptr);
 }
 
 void XClient::save_pointer()
 {
-	Position p = xpointer::get_pos(m_parent);
+	Position p = get_pointer();
 	if (m_geom.contains(p, Coordinates::Window)) {
 		m_ptr = p;
 	} else {
@@ -818,6 +866,22 @@ void XClient::save_pointer()
 	}
 }
 
+// Pointer position relative to the inside of the frame, as last configured
+Position XClient::get_pointer()
+{
+	Position p = xpointer::get_pos(m_rootwin);
+	int border = m_border_applied;
+	return Position(p.x - m_geom_applied.x - border,
+			p.y - m_geom_applied.y - border);
+}
+
+void XClient::set_pointer(Position p)
+{
+	int border = m_border_applied;
+	xpointer::set_pos(m_rootwin, Position(m_geom_applied.x + border + p.x,
+				m_geom_applied.y + border + p.y));
+}
+
 void XClient::set_stacked_geom()
 {
 	m_geom = m_geom_stack;
@@ -826,14 +890,14 @@ void XClient::set_stacked_geom()
 	else
 		m_border_w = conf::stacked_border;
 
-	resize_window();
+	apply_geometry();
 }
 
 void XClient::set_tiled_geom(Geometry &tiled)
 {
 	m_geom = tiled;
 	m_border_w = conf::tiled_border;
-	resize_window();
+	apply_geometry();
 }
 
 void XClient::set_notile()
@@ -910,7 +974,9 @@ void XClient::toggle_state(long flags)
 			toggle_fullscreen();
 		break;
 	}
-	ewmh::set_net_wm_states(m_window, m_states);
+	set_net_wm_states();
+	m_screen->panel_update_desktop_list();
+	m_screen->panel_update_client_list();
 }
 
 void XClient::toggle_fullscreen()
@@ -23,6 +23,8 @@
 #ifndef _XCLIENT_H_
 #define _XCLIENT_H_
 #include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "enums.h"
@@ -30,6 +32,7 @@
 
 //class XClient;
 class XScreen;
+class XQuery;
 
 struct MotifHints {
 	unsigned long	flags;
@@ -48,9 +51,17 @@ class XClient {
 	long			 m_states;
 	int			 m_initial_state;
 	Colormap		 m_colormap;
+	XID			 m_sync_counter;
 	Geometry		 m_geom;
 	Geometry 		 m_geom_stack;
 	Geometry 		 m_geom_save;
+	// Last values sent to the server
+	Geometry		 m_geom_applied;
+	size_t			 m_border_applied;
+	unsigned long		 m_pixel_applied;
+	long			 m_net_states_applied;
+	long			 m_wm_state_applied;
+	bool			 m_mapped;
 	Position		 m_ptr;
 	SizeHints		 m_hints;
 	size_t			 m_border_w;
@@ -60,7 +71,7 @@ class XClient {
 	std::string		 m_res_class;
 	std::string		 m_res_name;
 public:
-	XClient(Window, XScreen*, bool);
+	XClient(XQuery&, XScreen*, bool);
 	~XClient();
 	Window			 get_window() const { return m_window; }
 	Window			 get_parent() const { return m_parent; }
@@ -75,12 +86,15 @@ public:
 	bool			 has_state(long s) const { return (m_states&s); }
 	void			 set_states(long s) { m_states |= s; }
 	int			 get_border() const { return m_border_w; }
+	XID			 get_sync_counter() const { return m_sync_counter; }
 	void			 set_border(int b) { m_border_w = b; }
 	long			 get_desktop_index() const { return m_deskindex; }
 	void			 set_desktop_index(long i) { m_deskindex = i; }
 	std::string		&get_res_name() { return m_res_name; }
 	std::string		&get_res_class() { return m_res_class; }
 	void			 set_removed() { m_removed = true; }
+	bool			 is_mapped() const { return m_mapped; }
+	void			 set_unmapped() { m_mapped = false; }
 	bool			 has_window(Window);
 	void			 assign_to_desktop(long);
 	void			 get_net_wm_name();
@@ -88,6 +102,7 @@ public:
 	void			 get_transient();
 	void			 get_wm_hints();
 	void			 get_wm_normal_hints();
+	void			 update_sync_counter();
 	void			 send_configure_event();
 	void			 configure_window(XConfigureRequestEvent *);
 	void			 draw_window_border();
@@ -99,10 +114,16 @@ public:
 	void			 raise_window();
 	void			 lower_window();
 	void			 move_window_with_keyboard(long);
-	void			 move_window_with_pointer();
+	void			 move_window_with_pointer(bool);
 	void			 move_window();
 	void			 resize_window_with_keyboard(long);
-	void			 resize_window_with_pointer();
+	void			 resize_window_with_pointer(bool);
+	void			 get_drag_geometry(DragMode, long, Position, Geometry &,
+						Geometry &);
+	bool			 drag_window(DragMode, long, Position, Geometry &,
+						int64_t *);
+	void			 get_drag_label(DragMode, Geometry &, char *, size_t);
+	void			 end_drag(DragMode);
 	void			 snap_window(long);
 	void			 save_pointer();
 	void			 warp_pointer();
@@ -113,20 +134,28 @@ public:
 	void			 set_tiled_geom(Geometry &);
 	void 			 set_notile();
 	void			 panel_update_title();
+	void			 send_title();
+	void			 panel_update_geometry();
 	void 			 change_states(int, Atom, Atom);
 	void			 toggle_state(long);
+	void			 set_wm_state(long);
+	static unsigned long	 get_writes_suppressed() { return s_writes_suppressed; }
 private:
 	void			 reparent_window();
 	void			 resize_window();
+	void			 apply_geometry();
 	void			 set_initial_placement();
  	void			 apply_user_states();
  	long			 get_configured_desktop();
-	void			 get_net_wm_window_type();
-	long			 get_net_wm_desktop();
-	void			 get_class_hint();
-	void			 get_motif_hints();
-	void			 get_wm_protocols();
+	void			 set_net_wm_window_type(std::vector<Atom>&);
+	void			 set_wm_hints(XWMHints&);
+	void			 set_wm_protocols(std::vector<Atom>&);
+	void			 set_transient(Window);
+	void			 set_motif_hints(MotifHints&);
 	void 			 remove_fullscreen();
-	static const long 	 MouseMask;
+	void			 set_net_wm_states();
+	Position		 get_pointer();
+	void			 set_pointer(Position);
+	static unsigned long	 s_writes_suppressed;
 };
 #endif /* _XCLIENT_H_ */
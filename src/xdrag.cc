@@ -0,0 +1,327 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <X11/Xlib.h>
+#include <X11/extensions/sync.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "timer.h"
+#include "config.h"
+#include "evloop.h"
+#include "wmcore.h"
+#include "xclient.h"
+#include "xscreen.h"
+#include "xwinprop.h"
+#include "xdrag.h"
+
+// Motion events only record the last position of the pointer. The window
+// is updated from it at most once per refresh of the monitor under the
+// pointer, when the timer expires.
+namespace xdrag {
+	using Clock = std::chrono::steady_clock;
+
+	const long	 MouseMask = ButtonReleaseMask|PointerMotionMask;
+	const double	 DefaultRate = 60.0;	// Hz, if the monitor rate is unknown
+	const int	 OutlineWidth = 2;
+	const long	 SyncTimeout = 200;	// msec, before giving up on sync
+
+	XClient		*client = NULL;
+	DragMode	 mode;
+	long		 direction;
+	Geometry	 origin;		// geometry at the start
+	Geometry	 frame;			// of the outline
+	bool		 outline;
+	Window		 edges[4] = { None, None, None, None };
+	XWinProp	*label = NULL;		// of the screen
+	Position	 target;		// last pointer position on root
+	bool		 pending = false;	// target not yet applied
+	bool		 scheduled = false;
+	Clock::time_point last;
+	XSyncAlarm	 alarm = None;		// triggered by the client counter
+	int64_t		 sync_value;		// last value requested
+	bool		 waiting = false;	// for the counter to reach it
+	unsigned long	 motions = 0;
+	unsigned long	 updates = 0;
+	unsigned long	 syncs = 0;
+
+	static void	 update();
+	static void	 schedule_update();
+	static long	 get_interval();
+	static void	 finish(bool);
+	static void	 create_outline();
+	static void	 draw_outline();
+	static void	 destroy_outline();
+	static void	 draw_label();
+	static void	 start_sync();
+	static void	 stop_sync();
+	static void	 sync_timeout();
+}
+
+// Grab the pointer and start dragging the client. Return false if the
+// pointer could not be grabbed.
+bool xdrag::start(XClient *c, DragMode m, long d, Cursor cursor, bool o)
+{
+	if (client) finish(true);
+	if (XGrabPointer(wm::display, c->get_parent(), False, MouseMask,
+			GrabModeAsync, GrabModeAsync, None, cursor,
+			CurrentTime) != GrabSuccess)
+		return false;
+
+	client = c;
+	mode = m;
+	direction = d;
+	outline = o;
+	pending = false;
+	motions = 0;
+	updates = 0;
+	syncs = 0;
+	last = Clock::now();
+
+	origin = client->get_geometry();
+	frame = origin;
+	if (outline) create_outline();
+	else if (mode == DragResize) start_sync();
+	label = client->get_screen()->get_winprop();
+	draw_label();
+	return true;
+}
+
+void xdrag::handle(XEvent *e)
+{
+	if (!client) return;
+
+	if (wm::xsync && ((e->type - wm::xsync_event_base) == XSyncAlarmNotify)) {
+		// The client has redrawn, it can be sent the next size
+		if (((XSyncAlarmNotifyEvent *)e)->alarm != alarm) return;
+		waiting = false;
+		evloop::cancel(sync_timeout);
+		if (pending) schedule_update();
+		return;
+	}
+
+	switch (e->type) {
+	case MotionNotify:
+		target = Position(e->xmotion.x_root, e->xmotion.y_root);
+		pending = true;
+		motions++;
+		schedule_update();
+		break;
+	case ButtonRelease:
+		target = Position(e->xbutton.x_root, e->xbutton.y_root);
+		pending = true;
+		finish(true);
+		break;
+	}
+}
+
+// The client is going away or is hidden: stop dragging it
+void xdrag::cancel(XClient *c)
+{
+	if (client != c) return;
+	finish(false);
+}
+
+static void xdrag::schedule_update()
+{
+	if (scheduled) return;
+	long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+				Clock::now() - last).count();
+	long delay = get_interval() - elapsed;
+	scheduled = true;
+	evloop::schedule((delay > 0) ? delay : 0, update);
+}
+
+// Apply the last position of the pointer to the window
+static void xdrag::update()
+{
+	scheduled = false;
+	if (!client || !pending || waiting) return;
+	pending = false;
+	last = Clock::now();
+	updates++;
+
+	// The outline geometry is only applied at the end of the drag
+	if (outline) {
+		client->get_drag_geometry(mode, direction, target, origin, frame);
+		draw_outline();
+		draw_label();
+		return;
+	}
+
+	int64_t *sync = (alarm != None) ? &sync_value : NULL;
+	if (client->drag_window(mode, direction, target, origin, sync)) {
+		XSyncValue value;
+		XSyncIntsToValue(&value, sync_value & 0xffffffff, sync_value >> 32);
+		XSyncAlarmAttributes attr;
+		attr.trigger.wait_value = value;
+		XSyncChangeAlarm(wm::display, alarm, XSyncCAValue, &attr);
+		waiting = true;
+		syncs++;
+		evloop::schedule(SyncTimeout, sync_timeout);
+	}
+	draw_label();
+}
+
+// Time between two frames of the monitor under the pointer, in msec
+static long xdrag::get_interval()
+{
+	double rate = DefaultRate;
+	Viewport *viewport = client->get_screen()->find_viewport(target);
+	if (viewport && (viewport->get_rate() > 0))
+		rate = viewport->get_rate();
+	long interval = 1000.0 / rate;
+	return (interval > 0) ? interval : 1;
+}
+
+// End the drag. If it is completed, the last position is applied.
+static void xdrag::finish(bool complete)
+{
+	if (scheduled) {
+		evloop::cancel(update);
+		scheduled = false;
+	}
+	// The last size is applied without waiting for the client
+	stop_sync();
+	if (complete && pending) update();
+	pending = false;
+
+	// The geometry of a completed outline drag is applied to the window
+	if (complete && outline && (frame != origin))
+		client->drag_window(mode, direction, target, origin, NULL);
+	XUngrabPointer(wm::display, CurrentTime);
+	label->hide();
+	label = NULL;
+	if (outline) destroy_outline();
+
+	if (conf::debug) {
+		std::cout << timer::gettime() << " [xdrag::" << __func__ << "] "
+			<< std::dec << motions << " motions, " << updates
+			<< " updates, " << syncs << " sync requests\n";
+	}
+	XClient *c = client;
+	client = NULL;
+	if (complete) c->end_drag(mode);
+}
+
+// The outline is made of four override-redirect windows, one per edge,
+// so that nothing under it needs to be redrawn as it moves.
+static void xdrag::create_outline()
+{
+	XScreen *screen = client->get_screen();
+	XSetWindowAttributes attr;
+	attr.override_redirect = True;
+	attr.background_pixel = screen->get_pixel(Color::WindowBorderActive);
+	for (Window &edge : edges) {
+		edge = XCreateWindow(wm::display, screen->get_window(), 0, 0, 1, 1,
+				0, CopyFromParent, InputOutput, CopyFromParent,
+				CWOverrideRedirect|CWBackPixel, &attr);
+	}
+	draw_outline();
+	for (Window edge : edges)
+		XMapRaised(wm::display, edge);
+}
+
+// Place the edges around the frame at its new geometry
+static void xdrag::draw_outline()
+{
+	Geometry &g = frame;
+	int w = g.w + 2 * client->get_border();
+	int h = g.h + 2 * client->get_border();
+	int t = (w > 2 * OutlineWidth && h > 2 * OutlineWidth) ? OutlineWidth : 1;
+	int side = (h > 2 * t) ? h - 2 * t : 1;
+
+	XMoveResizeWindow(wm::display, edges[0], g.x, g.y, w, t);
+	XMoveResizeWindow(wm::display, edges[1], g.x, g.y + h - t, w, t);
+	XMoveResizeWindow(wm::display, edges[2], g.x, g.y + t, t, side);
+	XMoveResizeWindow(wm::display, edges[3], g.x + w - t, g.y + t, t, side);
+}
+
+// The label stays in the middle of the window as configured
+static void xdrag::draw_label()
+{
+	Geometry &geom = outline ? origin : client->get_geometry();
+	int border = client->get_border();
+	char text[XWinProp::TextSize];
+	client->get_drag_label(mode, outline ? frame : geom, text, sizeof(text));
+	label->draw(text, geom.x + border + geom.w/2, geom.y + border + geom.h/2);
+}
+
+static void xdrag::destroy_outline()
+{
+	for (Window &edge : edges) {
+		XDestroyWindow(wm::display, edge);
+		edge = None;
+	}
+}
+
+// Watch the counter of a client that supports sync requests with an
+// alarm. It is only used for an opaque resize.
+static void xdrag::start_sync()
+{
+	XID counter = client->get_sync_counter();
+	if (!wm::xsync || !client->has_state(State::WMSyncRequest) || !counter)
+		return;
+
+	XSyncValue value;
+	if (!XSyncQueryCounter(wm::display, counter, &value))
+		return;
+	sync_value = ((int64_t)XSyncValueHigh32(value) << 32) |
+			XSyncValueLow32(value);
+
+	// The alarm is armed with a new value by each sync request. It is
+	// inactive in between since it does not have a delta.
+	XSyncAlarmAttributes attr;
+	attr.trigger.counter = counter;
+	attr.trigger.value_type = XSyncAbsolute;
+	XSyncIntsToValue(&attr.trigger.wait_value, (sync_value + 1) & 0xffffffff,
+			(sync_value + 1) >> 32);
+	attr.trigger.test_type = XSyncPositiveComparison;
+	XSyncIntToValue(&attr.delta, 0);
+	attr.events = True;
+	alarm = XSyncCreateAlarm(wm::display, XSyncCACounter|XSyncCAValueType|
+			XSyncCAValue|XSyncCATestType|XSyncCADelta|XSyncCAEvents,
+			&attr);
+	waiting = false;
+}
+
+static void xdrag::stop_sync()
+{
+	if (alarm == None) return;
+	evloop::cancel(sync_timeout);
+	XSyncDestroyAlarm(wm::display, alarm);
+	alarm = None;
+	waiting = false;
+}
+
+// The client did not update its counter in time. The rest of the drag
+// goes on without sync requests.
+static void xdrag::sync_timeout()
+{
+	if (conf::debug) {
+		std::cout << timer::gettime() << " [xdrag::" << __func__
+			<< "] no reply from window 0x" << std::hex
+			<< client->get_window() << '\n';
+	}
+	stop_sync();
+	if (pending) schedule_update();
+}
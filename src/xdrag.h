@@ -0,0 +1,41 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _XDRAG_H_
+#define _XDRAG_H_
+#include <X11/Xlib.h>
+#include "enums.h"
+
+class XClient;
+
+// Window moved or resized with the pointer. The drag is driven by the
+// pointer events received in the main loop, so that the other events and
+// the sockets are still serviced while it lasts. In outline mode, only an
+// outline follows the pointer and the window is configured once at the end.
+// Clients supporting _NET_WM_SYNC_REQUEST are not sent a new size before
+// they have redrawn at the previous one.
+namespace xdrag {
+	bool		 start(XClient *, DragMode, long, Cursor, bool);
+	void		 handle(XEvent *);
+	void		 cancel(XClient *);
+}
+#endif // _XDRAG_H_
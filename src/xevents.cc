@@ -21,17 +21,23 @@
 // SOFTWARE.
 
 #include <X11/extensions/Xrandr.h>
+#include <X11/extensions/sync.h>
 #include <X11/XKBlib.h>
 #include <X11/Xatom.h>
 #include <X11/Xlib.h>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 #include "timer.h"
 #include "config.h"
 #include "bind.h"
 #include "wmhints.h"
 #include "wmcore.h"
 #include "xclient.h"
+#include "xdrag.h"
+#include "xpointer.h"
 #include "xscreen.h"
+#include "xwinprop.h"
 #include "xevents.h"
 
 namespace XEvents {
@@ -49,6 +55,28 @@ namespace XEvents {
 	static void client_message(XEvent *);
 	static void mappping_notify(XEvent *);
 	static void screen_change_notify(XEvent *);
+	static void coalesce();
+	static void merge_configure_request(XConfigureRequestEvent *,
+						XConfigureRequestEvent *);
+
+	// Type given to the events dropped by coalescing
+	static const int Dropped = 0;
+
+	enum Slot {
+		SlotConfigure,
+		SlotExpose,
+		SlotName,
+		SlotNormalHints,
+		SlotHints,
+		NumSlots
+	};
+	struct Slots {
+		long	 index[NumSlots];
+	};
+
+	static std::vector<XEvent>			 queue;
+	static std::unordered_map<Window, Slots>	 slots;
+	static Stats					 stats;
 
 	static const long IgnoreModMask	= LockMask|Mod2Mask|0x2000;
 
@@ -84,28 +112,9 @@ static void XEvents::key_press(XEvent *ee)
 	XClient	*client = XScreen::find_client(e->window);
 	if (!client) client = screen->get_active_client();
 
-	KeySym keysym = XkbKeycodeToKeysym(wm::display, e->keycode, 0, 0);
-	KeySym skeysym = XkbKeycodeToKeysym(wm::display, e->keycode, 0, 1);
-
 	e->state &= ~IgnoreModMask;
 
-	Bind *kb = NULL;
-	for (Bind& ckb : conf::keybindings) {
-		if (!client && ckb.context == Context::Window)
-			continue;
-
-		unsigned int	 modshift = 0;
-		if (keysym != ckb.keysym && skeysym == ckb.keysym)
-			modshift = ShiftMask;
-
-		if ((ckb.modmask | modshift) != e->state)
-			continue;
-
-		if (ckb.keysym == ((modshift == 0) ? keysym : skeysym)) {
-			kb = &ckb;
-			break;
-		}
-	}
+	Bind *kb = bindtable::find_key(e->keycode, e->state, client != NULL);
 	if (!kb) {
 		if (conf::debug>1) {
 			std::cout << timer::gettime() << " [XEvents::" << __func__
@@ -183,14 +192,7 @@ static void XEvents::button_press(XEvent *ee)
 	XClient	*client = XScreen::find_client(e->window);
 	e->state &= ~IgnoreModMask;
 
-	Bind *mb = NULL;
-	for (Bind& cmb : conf::mousebindings) {
-		if (e->button != cmb.button || e->state != cmb.modmask) continue;
-		if (client && cmb.context == Context::Root) continue;
-		if (!client && cmb.context == Context::Window) continue;
-		mb = &cmb;
-		break;
-	}
+	Bind *mb = bindtable::find_button(e->button, e->state, client != NULL);
 	if (!mb) return;
 
 	switch (mb->context) {
@@ -254,8 +256,16 @@ static void XEvents::expose(XEvent *ee)
 			<< "] window 0x" << std::hex << e->window << '\n';
 	}
 
+	if (e->count) return;
 	XClient *client = XScreen::find_client(e->window);
-	if ((client) && e->count == 0) client->draw_window_border();
+	if (client) {
+		client->draw_window_border();
+		return;
+	}
+	for (XScreen *screen : wm::screenlist) {
+		XWinProp *label = screen->get_winprop();
+		if (label->get_window() == e->window) label->redraw();
+	}
 }
 
 static void XEvents::destroy_notify(XEvent *ee)
@@ -281,9 +291,9 @@ static void XEvents::unmap_notify(XEvent *ee)
 			<< "] window 0x" << std::hex << e->window << '\n';
 	}
 	if (!e->send_event) return;
-	if (XScreen::find_client(e->window)) {
-		wmh::set_wm_state(e->window, WithdrawnState);
-	}
+	XClient *client = XScreen::find_client(e->window);
+	if (client)
+		client->set_wm_state(WithdrawnState);
 }
 
 static void XEvents::map_request(XEvent *ee)
@@ -308,8 +318,13 @@ static void XEvents::map_request(XEvent *ee)
 		active_client->save_pointer();
 
 	XClient *client = XScreen::find_client(e->window);
-	if (!client)
+	if (!client) {
 		screen->add_client(e->window);
+	} else {
+		// A withdrawn client is mapped again by the next layout
+		client->set_unmapped();
+		screen->show_desktop();
+	}
 }
 
 static void XEvents::configure_request(XEvent *ee)
@@ -360,6 +375,7 @@ static void XEvents::property_notify(XEvent *ee)
 		case XA_WM_HINTS:
 			client->get_wm_hints();
 			client->draw_window_border();
+			screen->panel_update_desktop_list();
 			break;
 		case XA_WM_TRANSIENT_FOR:
 			client->get_transient();
@@ -371,6 +387,8 @@ static void XEvents::property_notify(XEvent *ee)
 		default:
 			if (e->atom == ewmh::hints[_NET_WM_NAME])
 				client->update_net_wm_name();
+			else if (e->atom == ewmh::hints[_NET_WM_SYNC_REQUEST_COUNTER])
+				client->update_sync_counter();
 			break;
 		}
 	} else {
@@ -447,6 +465,7 @@ static void XEvents::mappping_notify(XEvent *e)
 
 	XRefreshKeyboardMapping(xev);
 	if (xev->request == MappingKeyboard) {
+		bindtable::build();
 		for (XScreen *screen : wm::screenlist)
 			screen->grab_keybindings();
 	}
@@ -479,14 +498,28 @@ static void XEvents::screen_change_notify(XEvent *e)
 
 void XEvents::process(void)
 {
-	XEvent	 e;
-
+	// Drain the queue first so that redundant events can be dropped
+	queue.clear();
 	while (XPending(wm::display)) {
-		XNextEvent(wm::display, &e);
+		queue.emplace_back();
+		XNextEvent(wm::display, &queue.back());
+	}
+	stats.events += queue.size();
+
+	coalesce();
+
+	for (XEvent &e : queue) {
+		if (e.type == Dropped) continue;
+		xpointer::update(&e);
 		if ((e.type - wm::xrandr_event_base) == RRScreenChangeNotify) {
 			screen_change_notify(&e);
 			continue;
 		}
+		if (wm::xsync &&
+			((e.type - wm::xsync_event_base) == XSyncAlarmNotify)) {
+			xdrag::handle(&e);
+			continue;
+		}
 		if (e.type >= LASTEvent) continue;
 
 		switch(e.type) {
@@ -499,6 +532,10 @@ void XEvents::process(void)
 		case ButtonPress:
 			button_press(&e);
 			break;
+		case ButtonRelease:
+		case MotionNotify:
+			xdrag::handle(&e);
+			break;
 		case EnterNotify:
 			enter_notify(&e);
 			break;
@@ -531,4 +568,108 @@ void XEvents::process(void)
 			break;
 		}
 	}
+	XFlush(wm::display);
+}
+
+// Drop the events made redundant by a later event of the same kind on the
+// same window: configure requests are merged into the last one, and only
+// the last name change, hints change or final expose is kept. Any other
+// event on a window ends the sequence that can be merged for it.
+static void XEvents::coalesce()
+{
+	slots.clear();
+	for (long i = 0; i < (long)queue.size(); i++) {
+		XEvent *e = &queue[i];
+		Window w = e->xany.window;
+		int slot = -1;
+
+		switch (e->type) {
+		case ConfigureRequest:
+			w = e->xconfigurerequest.window;
+			slot = SlotConfigure;
+			break;
+		case Expose:
+			if (e->xexpose.count) continue;
+			slot = SlotExpose;
+			break;
+		case PropertyNotify:
+			if ((e->xproperty.atom == XA_WM_NAME) ||
+				(e->xproperty.atom == ewmh::hints[_NET_WM_NAME]))
+				slot = SlotName;
+			else if (e->xproperty.atom == XA_WM_NORMAL_HINTS)
+				slot = SlotNormalHints;
+			else if (e->xproperty.atom == XA_WM_HINTS)
+				slot = SlotHints;
+			else continue;
+			break;
+		case MapRequest:
+			w = e->xmaprequest.window;
+			break;
+		case DestroyNotify:
+			w = e->xdestroywindow.window;
+			break;
+		case UnmapNotify:
+			w = e->xunmap.window;
+			break;
+		}
+
+		if (slot == -1) {
+			slots.erase(w);
+			continue;
+		}
+
+		auto it = slots.find(w);
+		if (it == slots.end()) {
+			Slots empty;
+			for (long &index : empty.index) index = -1;
+			it = slots.emplace(w, empty).first;
+		}
+		long prev = it->second.index[slot];
+		it->second.index[slot] = i;
+		if (prev == -1) continue;
+
+		switch (slot) {
+		case SlotConfigure:
+			merge_configure_request(&queue[prev].xconfigurerequest,
+						&e->xconfigurerequest);
+			stats.configure_dropped++;
+			break;
+		case SlotExpose:
+			stats.expose_dropped++;
+			break;
+		default:
+			stats.property_dropped++;
+			break;
+		}
+		queue[prev].type = Dropped;
+	}
+}
+
+// Add the values of an earlier configure request not set by the later one.
+static void XEvents::merge_configure_request(XConfigureRequestEvent *prev,
+						XConfigureRequestEvent *e)
+{
+	unsigned long missing = prev->value_mask & ~e->value_mask;
+	if (missing & CWX) e->x = prev->x;
+	if (missing & CWY) e->y = prev->y;
+	if (missing & CWWidth) e->width = prev->width;
+	if (missing & CWHeight) e->height = prev->height;
+	if (missing & CWBorderWidth) e->border_width = prev->border_width;
+	if (missing & CWSibling) e->above = prev->above;
+	if (missing & CWStackMode) e->detail = prev->detail;
+	e->value_mask |= missing;
+}
+
+const XEvents::Stats &XEvents::get_stats()
+{
+	return stats;
+}
+
+void XEvents::print_stats()
+{
+	std::cout << timer::gettime() << " [XEvents::" << __func__ << "] "
+		<< std::dec << stats.events << " events, dropped "
+		<< stats.configure_dropped << " configure requests, "
+		<< stats.property_dropped << " property notifications, "
+		<< stats.expose_dropped << " exposures\n";
 }
@@ -23,6 +23,14 @@
 #ifndef _XEVENTS_H_
 #define _XEVENTS_H_
 namespace XEvents {
-	void process(void);
+	struct Stats {
+		unsigned long	 events;
+		unsigned long	 configure_dropped;
+		unsigned long	 property_dropped;
+		unsigned long	 expose_dropped;
+	};
+	void		 process(void);
+	const Stats	&get_stats();
+	void		 print_stats();
 };
 #endif /* _XEVENTS_H_ */
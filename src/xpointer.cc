@@ -23,17 +23,81 @@
 #include "wmcore.h"
 #include "xpointer.h"
 
-Position xpointer::get_pos(Window window)
+namespace xpointer {
+	Window		 root = None;	// root window where the pointer is
+	Position	 pos;
+	bool		 valid = false;
+	Stats		 stats = { 0, 0 };
+}
+
+// Return the position on the root window, querying the server only if
+// it is not known since the last wakeup.
+Position xpointer::get_pos(Window rootwin)
+{
+	if (!valid) {
+		Window		 child;
+		int		 rx, ry, wx, wy;
+		unsigned int	 mask;
+
+		XQueryPointer(wm::display, rootwin, &root, &child, &rx, &ry,
+				&wx, &wy, &mask);
+		pos = Position(rx, ry);
+		valid = true;
+		stats.queries++;
+	} else
+		stats.hits++;
+
+	// The pointer is on another screen
+	if (root != rootwin)
+		return Position(0, 0);
+	return pos;
+}
+
+void xpointer::set_pos(Window rootwin, Position p)
+{
+	XWarpPointer(wm::display, None, rootwin, 0, 0, 0, 0, p.x, p.y);
+	root = rootwin;
+	pos = p;
+	valid = true;
+}
+
+// Remember the position carried by an input event
+void xpointer::update(XEvent *e)
 {
-	Window		 root, child;
-	int		 rx, ry, wx, wy;
-	unsigned int	 mask;
+	if (e->xany.send_event) return;
+	switch (e->type) {
+	case KeyPress:
+	case KeyRelease:
+		root = e->xkey.root;
+		pos = Position(e->xkey.x_root, e->xkey.y_root);
+		break;
+	case ButtonPress:
+	case ButtonRelease:
+		root = e->xbutton.root;
+		pos = Position(e->xbutton.x_root, e->xbutton.y_root);
+		break;
+	case MotionNotify:
+		root = e->xmotion.root;
+		pos = Position(e->xmotion.x_root, e->xmotion.y_root);
+		break;
+	case EnterNotify:
+	case LeaveNotify:
+		root = e->xcrossing.root;
+		pos = Position(e->xcrossing.x_root, e->xcrossing.y_root);
+		break;
+	default:
+		return;
+	}
+	valid = true;
+}
 
-	XQueryPointer(wm::display, window, &root, &child, &rx,  &ry, &wx, &wy, &mask);
-	return Position(wx, wy);
+// The pointer may have moved while the event loop was waiting
+void xpointer::invalidate()
+{
+	valid = false;
 }
 
-void xpointer::set_pos(Window window, Position p)
+const xpointer::Stats xpointer::get_stats()
 {
-	XWarpPointer(wm::display, None, window, 0, 0, 0, 0, p.x, p.y);
+	return stats;
 }
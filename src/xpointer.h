@@ -26,9 +26,19 @@
 #include "enums.h" 
 #include "geometry.h" 
 
+// Position of the pointer on the root window. The position carried by the
+// last input event is kept until the next wakeup of the event loop, and
+// the server is only queried when it is not known.
 namespace xpointer {
+	struct Stats {
+		unsigned long	hits;
+		unsigned long	queries;
+	};
 	Position get_pos(Window);
 	void set_pos(Window, Position);
+	void update(XEvent *);
+	void invalidate();
+	const Stats get_stats();
 }
 
 #endif /* _XPOINTER_H_ */
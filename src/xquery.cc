@@ -0,0 +1,298 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <X11/Xlib-xcb.h>
+#include <X11/Xatom.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "timer.h"
+#include "config.h"
+#include "wmcore.h"
+#include "wmhints.h"
+#include "xquery.h"
+
+// Number of 32 bit elements of the ICCCM hints
+enum {
+	WMHintsElements		= 9,
+	SizeHintsElements	= 18,
+	OldSizeHintsElements	= 15,
+};
+
+XQuery::XQuery(Window w): m_window(w)
+{
+	xcb_connection_t *conn = XGetXCBConnection(wm::display);
+
+	m_fetched = false;
+	valid = false;
+
+	// Property changes made after the requests below are reported as
+	// events, so nothing can be missed between the query and the adoption.
+	uint32_t mask = PropertyChangeMask;
+	xcb_change_window_attributes(conn, w, XCB_CW_EVENT_MASK, &mask);
+
+	m_attr_cookie = xcb_get_window_attributes(conn, w);
+	m_geom_cookie = xcb_get_geometry(conn, w);
+
+	struct { Property prop; Atom atom; Atom type; uint32_t length; } requests[] = {
+		{ NetWMName, ewmh::hints[_NET_WM_NAME], AnyPropertyType, 0xffffff },
+		{ WMName, XA_WM_NAME, AnyPropertyType, 0xffffff },
+		{ NetWMWindowType, ewmh::hints[_NET_WM_WINDOW_TYPE], XA_ATOM, 64 },
+		{ WMHints, XA_WM_HINTS, XA_WM_HINTS, WMHintsElements },
+		{ WMClass, XA_WM_CLASS, XA_STRING, 2048 },
+		{ WMProtocols, wmh::hints[WM_PROTOCOLS], XA_ATOM, 1024 },
+		{ WMNormalHints, XA_WM_NORMAL_HINTS, XA_WM_SIZE_HINTS, SizeHintsElements },
+		{ WMTransientFor, XA_WM_TRANSIENT_FOR, XA_WINDOW, 1 },
+		{ MotifWMHints, wmh::hints[_MOTIF_WM_HINTS], wmh::hints[_MOTIF_WM_HINTS],
+			Motif::HintElements },
+		{ NetWMState, ewmh::hints[_NET_WM_STATE], XA_ATOM, 1024 },
+		{ NetWMDesktop, ewmh::hints[_NET_WM_DESKTOP], XA_CARDINAL, 1 },
+		{ NetWMSyncRequestCounter, ewmh::hints[_NET_WM_SYNC_REQUEST_COUNTER],
+			XA_CARDINAL, 2 },
+	};
+	for (auto &r : requests)
+		m_prop_cookies[r.prop] = xcb_get_property(conn, 0, w, r.atom,
+							r.type, 0, r.length);
+}
+
+XQuery::~XQuery()
+{
+	if (m_fetched) return;
+
+	// Replies that were never collected must be discarded
+	xcb_connection_t *conn = XGetXCBConnection(wm::display);
+	xcb_discard_reply(conn, m_attr_cookie.sequence);
+	xcb_discard_reply(conn, m_geom_cookie.sequence);
+	for (auto &cookie : m_prop_cookies)
+		xcb_discard_reply(conn, cookie.sequence);
+}
+
+// Wait for all replies. Returns false if the window no longer exists.
+bool XQuery::fetch()
+{
+	if (m_fetched) return valid;
+	m_fetched = true;
+
+	xcb_connection_t *conn = XGetXCBConnection(wm::display);
+	xcb_generic_error_t *attr_err = NULL, *geom_err = NULL;
+	xcb_get_window_attributes_reply_t *attr =
+		xcb_get_window_attributes_reply(conn, m_attr_cookie, &attr_err);
+	xcb_get_geometry_reply_t *geom =
+		xcb_get_geometry_reply(conn, m_geom_cookie, &geom_err);
+
+	if (attr && geom) {
+		valid = true;
+		override_redirect = attr->override_redirect;
+		map_state = attr->map_state;
+		colormap = attr->colormap;
+		x = geom->x;
+		y = geom->y;
+		w = geom->width;
+		h = geom->height;
+		border_width = geom->border_width;
+	}
+	free(attr);
+	free(geom);
+	free(attr_err);
+	free(geom_err);
+
+	if (!valid) {
+		if (conf::debug) {
+			std::cout << timer::gettime() << " [XQuery::" << __func__
+				<< "] Window 0x" << std::hex << m_window
+				<< " is gone" << std::endl;
+		}
+		for (auto &cookie : m_prop_cookies)
+			xcb_discard_reply(conn, cookie.sequence);
+		return false;
+	}
+
+	std::string wm_name;
+	get_text(NetWMName, name);
+	get_text(WMName, wm_name);
+	if (name.empty()) name = wm_name;
+	get_atoms(NetWMWindowType, window_type);
+
+	xcb_get_property_reply_t *reply;
+
+	// Same conversions as XGetWMHints and XGetWMNormalHints
+	has_wm_hints = false;
+	reply = get_reply(WMHints);
+	if (reply && (reply->format == 32) &&
+		(xcb_get_property_value_length(reply) >= (WMHintsElements-1) * 4)) {
+		uint32_t *v = (uint32_t *)xcb_get_property_value(reply);
+		memset(&wm_hints, 0, sizeof(wm_hints));
+		wm_hints.flags = v[0];
+		wm_hints.input = v[1] ? True : False;
+		wm_hints.initial_state = v[2];
+		has_wm_hints = true;
+	}
+	free(reply);
+
+	normal_hints.flags = 0;
+	reply = get_reply(WMNormalHints);
+	if (reply && (reply->format == 32) &&
+		(reply->value_len >= OldSizeHintsElements)) {
+		int32_t *v = (int32_t *)xcb_get_property_value(reply);
+		long supplied = USPosition|USSize|PAllHints;
+		normal_hints.flags = v[0];
+		normal_hints.x = v[1];
+		normal_hints.y = v[2];
+		normal_hints.width = v[3];
+		normal_hints.height = v[4];
+		normal_hints.min_width = v[5];
+		normal_hints.min_height = v[6];
+		normal_hints.max_width = v[7];
+		normal_hints.max_height = v[8];
+		normal_hints.width_inc = v[9];
+		normal_hints.height_inc = v[10];
+		normal_hints.min_aspect.x = v[11];
+		normal_hints.min_aspect.y = v[12];
+		normal_hints.max_aspect.x = v[13];
+		normal_hints.max_aspect.y = v[14];
+		if (reply->value_len >= SizeHintsElements) {
+			normal_hints.base_width = v[15];
+			normal_hints.base_height = v[16];
+			normal_hints.win_gravity = v[17];
+			supplied |= PBaseSize|PWinGravity;
+		}
+		normal_hints.flags &= supplied;
+	}
+	free(reply);
+
+	// WM_CLASS holds the instance name followed by the class name
+	reply = get_reply(WMClass);
+	if (reply && (reply->format == 8)) {
+		char *v = (char *)xcb_get_property_value(reply);
+		int len = xcb_get_property_value_length(reply);
+		int n = strnlen(v, len);
+		res_name.assign(v, n);
+		if (n < len) res_class.assign(v + n + 1, strnlen(v + n + 1, len - n - 1));
+	}
+	free(reply);
+
+	get_atoms(WMProtocols, protocols);
+
+	transient_for = None;
+	reply = get_reply(WMTransientFor);
+	if (reply && (reply->format == 32) && (reply->value_len == 1))
+		transient_for = *(uint32_t *)xcb_get_property_value(reply);
+	free(reply);
+
+	has_motif_hints = false;
+	reply = get_reply(MotifWMHints);
+	if (reply && (reply->format == 32) &&
+		(reply->value_len == Motif::HintElements)) {
+		uint32_t *v = (uint32_t *)xcb_get_property_value(reply);
+		motif_hints.flags = v[0];
+		motif_hints.functions = v[1];
+		motif_hints.decorations = v[2];
+		motif_hints.inputMode = (int32_t)v[3];
+		motif_hints.status = v[4];
+		has_motif_hints = true;
+	}
+	free(reply);
+
+	get_atoms(NetWMState, net_wm_state);
+
+	has_net_wm_desktop = false;
+	reply = get_reply(NetWMDesktop);
+	if (reply && (reply->format == 32) && (reply->value_len == 1)) {
+		// The value is signed, 0xffffffff means all desktops
+		net_wm_desktop = *(int32_t *)xcb_get_property_value(reply);
+		has_net_wm_desktop = true;
+	}
+	free(reply);
+
+	// The second counter of the extended protocol is not used
+	sync_counter = None;
+	reply = get_reply(NetWMSyncRequestCounter);
+	if (reply && (reply->format == 32) && (reply->value_len >= 1))
+		sync_counter = *(uint32_t *)xcb_get_property_value(reply);
+	free(reply);
+
+	return true;
+}
+
+// Windows are managed unless they bypass the window manager. Existing
+// windows are adopted only if they are mapped.
+bool XQuery::can_manage(bool existing)
+{
+	if (!fetch()) return false;
+	if (override_redirect || (existing && (map_state != IsViewable))) {
+		// Undo the event selection of the query
+		XSelectInput(wm::display, m_window, NoEventMask);
+		return false;
+	}
+	return true;
+}
+
+// Returns the reply of a property request, or NULL if the property is
+// not set with the requested type. The reply must be freed by the caller.
+xcb_get_property_reply_t *XQuery::get_reply(Property prop)
+{
+	xcb_connection_t *conn = XGetXCBConnection(wm::display);
+	xcb_generic_error_t *err = NULL;
+	xcb_get_property_reply_t *reply = xcb_get_property_reply(conn,
+						m_prop_cookies[prop], &err);
+	free(err);
+	if (reply && (reply->type == XCB_NONE)) {
+		free(reply);
+		return NULL;
+	}
+	return reply;
+}
+
+void XQuery::get_text(Property prop, std::string &str)
+{
+	xcb_get_property_reply_t *reply = get_reply(prop);
+	if (!reply) return;
+
+	// Xlib expects a null terminated value
+	int len = xcb_get_property_value_length(reply);
+	std::vector<unsigned char> value(len + 1, 0);
+	memcpy(value.data(), xcb_get_property_value(reply), len);
+
+	XTextProperty tp;
+	tp.value = value.data();
+	tp.encoding = reply->type;
+	tp.format = reply->format;
+	tp.nitems = reply->value_len;
+	free(reply);
+
+	std::vector<char> text;
+	if (tp.nitems && wmh::convert_text_property(tp, text)) {
+		str = std::string(text.begin(), text.end());
+		if (!str.empty()) str.pop_back();
+	}
+}
+
+void XQuery::get_atoms(Property prop, std::vector<Atom> &atoms)
+{
+	xcb_get_property_reply_t *reply = get_reply(prop);
+	if (!reply) return;
+	if (reply->format == 32) {
+		uint32_t *v = (uint32_t *)xcb_get_property_value(reply);
+		atoms.assign(v, v + reply->value_len);
+	}
+	free(reply);
+}
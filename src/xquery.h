@@ -0,0 +1,89 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _XQUERY_H_
+#define _XQUERY_H_
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <xcb/xcb.h>
+#include <string>
+#include <vector>
+#include "xclient.h"
+
+// Requests needed to adopt a client window. They are all sent at once
+// on construction and the replies are collected by fetch(), so that the
+// adoption costs a single round trip to the server.
+class XQuery {
+	enum Property {
+		NetWMName,
+		WMName,
+		NetWMWindowType,
+		WMHints,
+		WMClass,
+		WMProtocols,
+		WMNormalHints,
+		WMTransientFor,
+		MotifWMHints,
+		NetWMState,
+		NetWMDesktop,
+		NetWMSyncRequestCounter,
+		NumProperties
+	};
+	Window					 m_window;
+	bool					 m_fetched;
+	xcb_get_window_attributes_cookie_t	 m_attr_cookie;
+	xcb_get_geometry_cookie_t		 m_geom_cookie;
+	xcb_get_property_cookie_t		 m_prop_cookies[NumProperties];
+	xcb_get_property_reply_t		*get_reply(Property);
+	void					 get_text(Property, std::string&);
+	void					 get_atoms(Property, std::vector<Atom>&);
+public:
+	bool			 valid;
+	bool			 override_redirect;
+	int			 map_state;
+	int			 x, y, w, h;
+	int			 border_width;
+	Colormap		 colormap;
+	std::string		 name;
+	std::vector<Atom>	 window_type;
+	bool			 has_wm_hints;
+	XWMHints		 wm_hints;
+	std::string		 res_name;
+	std::string		 res_class;
+	std::vector<Atom>	 protocols;
+	XSizeHints		 normal_hints;
+	Window			 transient_for;
+	bool			 has_motif_hints;
+	MotifHints		 motif_hints;
+	std::vector<Atom>	 net_wm_state;
+	bool			 has_net_wm_desktop;
+	long			 net_wm_desktop;
+	XID			 sync_counter;
+
+	XQuery(Window);
+	XQuery(const XQuery&) = delete;
+	~XQuery();
+	Window			 get_window() const { return m_window; }
+	bool			 fetch();
+	bool			 can_manage(bool);
+};
+#endif /* _XQUERY_H_ */
@@ -24,20 +24,28 @@
 #include <X11/XKBlib.h>
 #include <X11/Xft/Xft.h>
 #include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
 #include <iostream>
-#include <regex>
-#include <sstream>
 #include <string>
 #include <vector>
 #include "bind.h"
 #include "config.h"
 #include "desktop.h"
-#include "socket.h"
+#include "json.h"
+#include "events.h"
+#include "stateexport.h"
 #include "timer.h"
 #include "wmcore.h"
 #include "wmhints.h"
 #include "xclient.h"
+#include "xquery.h"
 #include "xscreen.h"
+#include "xwinprop.h"
+
+std::unordered_map<Window, WinRef> XScreen::s_winmap;
+XClient *XScreen::s_active = NULL;
 
 XScreen::XScreen(int id): m_screenid(id)
 {
@@ -50,6 +58,29 @@ XScreen::XScreen(int id): m_screenid(id)
 	m_colormap = DefaultColormap(wm::display, m_screenid);
 	m_visual = DefaultVisual(wm::display, m_screenid);
 	m_cycling = false;
+	m_layout_pending = false;
+	m_pending_client = NULL;
+	m_pending_actions = 0;
+	// Lists left by a previous window manager are always replaced
+	m_client_lists_dirty = true;
+	m_client_lists_written = false;
+	m_panel_desklist_dirty = false;
+	m_panel_clientlist_dirty = false;
+	m_panel_focus_dirty = false;
+	m_panel_focus = None;
+	m_net_active_window = None;
+	m_net_active_written = ~0UL;
+	m_panel_generation = 0;
+	m_state_export = NULL;
+	m_state_dirty = true;
+	s_winmap[m_rootwin] = WinRef(this, NULL);
+
+	if (conf::state_export) {
+		std::filesystem::path dir = std::filesystem::path(conf::command_socket)
+						.parent_path();
+		std::string path = dir / ("state-" + std::to_string(m_screenid));
+		m_state_export = new StateExport(path, m_screenid);
+	}
 
 	// Desktops
 	int index = 0;
@@ -94,6 +125,7 @@ XScreen::XScreen(int id): m_screenid(id)
 		}
 		m_palette.push_back(xc);
 	}
+	m_winprop = new XWinProp(this);
 
 	grab_keybindings();
 
@@ -115,16 +147,21 @@ XScreen::~XScreen()
 			<< "] REMOVE screen " << m_screenid << std::endl;
 	}
 
-	for (XClient *client : m_clientlist)
+	for (XClient *client : m_clientlist) {
+		unindex_client(client);
 		delete client;
+	}
+	s_winmap.erase(m_rootwin);
 
 	for (XftColor &color : m_palette)
 		XftColorFree(wm::display, DefaultVisual(wm::display, m_screenid),
 		    DefaultColormap(wm::display, m_screenid),
 		    &color);
 
+	delete m_winprop;
 	XftFontClose(wm::display, m_propfont);
 	XUngrabKey(wm::display, AnyKey, AnyModifier, m_rootwin);
+	delete m_state_export;
 }
 
 
@@ -134,19 +171,11 @@ void XScreen::grab_keybindings()
 		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
 	}
 	XUngrabKey(wm::display, AnyKey, AnyModifier, m_rootwin);
-	for (Bind& kb : conf::keybindings) {
-		KeyCode kc = XKeysymToKeycode(wm::display, kb.keysym);
-		if (!kc) {
-			std::cerr << timer::gettime() << " XScreen::" << __func__
-				<< "] Failed converting '" << XKeysymToString(kb.keysym)
-				<< "' keysym to keycode" << std::endl;
-			continue;
-		}
-		if ((XkbKeycodeToKeysym(wm::display, kc, 0, 0) != kb.keysym) &&
-			(XkbKeycodeToKeysym(wm::display, kc, 0, 1) == kb.keysym))
-			kb.modmask |= ShiftMask;
+	for (auto &entry : bindtable::keys) {
+		KeyCode kc = entry.first >> 16;
+		unsigned int modmask = entry.first & 0xffff;
 		for (auto mod : wm::ignore_mods)
-			XGrabKey(wm::display, kc, (kb.modmask | mod), m_rootwin,
+			XGrabKey(wm::display, kc, (modmask | mod), m_rootwin,
 					True, GrabModeAsync, GrabModeAsync);
 	}
 }
@@ -163,8 +192,8 @@ unsigned long XScreen::get_pixel(Color c)
 
 XClient *XScreen::get_active_client()
 {
-	for (XClient *client : m_clientlist)
-		if (client->has_state(State::Active)) return client;
+	if (s_active && (s_active->get_screen() == this))
+		return s_active;
 	return NULL;
 }
 
@@ -178,12 +207,28 @@ void XScreen::add_existing_clients()
 		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
 	}
 
+	auto t0 = std::chrono::steady_clock::now();
+
+	// Send the queries for all windows before waiting for any reply
+	std::deque<XQuery> queries;
 	if (XQueryTree(wm::display, m_rootwin, &w0, &w1, &wins, &nwins)) {
 		for (size_t i = 0; i < nwins; i++)
-			if (can_manage(wins[i], true))
-				m_clientlist.push_back(new XClient(wins[i], this, true));
+			queries.emplace_back(wins[i]);
 		XFree(wins);
 	}
+	for (XQuery &query : queries)
+		query.fetch();
+	auto t1 = std::chrono::steady_clock::now();
+
+	// Create all frames and lay out each desktop once in a single grab
+	XGrabServer(wm::display);
+	for (XQuery &query : queries) {
+		if (!query.can_manage(true)) continue;
+		XClient *client = new XClient(query, this, true);
+		m_clientlist.push_back(client);
+		index_client(client);
+	}
+	auto t2 = std::chrono::steady_clock::now();
 
 	update_geometry();
 	update_net_client_lists();
@@ -194,6 +239,18 @@ void XScreen::add_existing_clients()
 		else
 			m_desktoplist[i].hide(m_clientlist);
 	}
+	XUngrabServer(wm::display);
+	XFlush(wm::display);
+	auto t3 = std::chrono::steady_clock::now();
+
+	if (conf::debug) {
+		using ms = std::chrono::duration<double, std::milli>;
+		std::cout << timer::gettime() << " [XScreen:" << __func__ << "] "
+			<< std::dec << m_clientlist.size() << "/" << queries.size()
+			<< " windows adopted: queries " << ms(t1 - t0).count()
+			<< " ms, frames " << ms(t2 - t1).count()
+			<< " ms, layout " << ms(t3 - t2).count() << " ms\n";
+	}
 
 	panel_update_desktop_name();
 	panel_update_desktop_list();
@@ -205,62 +262,46 @@ void XScreen::add_existing_clients()
 	if (cwin == None) return;
 
 	// Set pointed window as active
-	for (XClient *client : m_clientlist) {
-		if (cwin == client->get_window()) {
-			if (!(client->has_states(State::Ignored)))
-				client->set_window_active();
-			break;
-		}
-	}
+	XClient *client = find_client(cwin);
+	if (client && !(client->has_states(State::Ignored)))
+		client->set_window_active();
 }
 
 void XScreen::add_client(Window window)
 {
-	if (!can_manage(window, false)) {
+	XQuery query(window);
+	if (!query.can_manage(false))
 		return;
-	}
 	if (conf::debug) {
 		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
 	}
-	m_clientlist.insert(m_clientlist.begin(), new XClient(window, this, false));
+	XClient *client = new XClient(query, this, false);
+	m_clientlist.insert(m_clientlist.begin(), client);
+	index_client(client);
 
-	XClient *client = m_clientlist.front();
 	if (client->has_state(State::Docked))
 		update_geometry();
 	update_net_client_lists();
 
+	// The client is warped to and activated once it is laid out
+	long actions = PendingActivate;
+	if (!client->has_states(State::Ignored))
+		actions |= PendingWarp|PendingRaise;
+
 	int index = client->get_desktop_index();
 	if (index == -1) {
-		m_desktoplist[m_desktop_active].show(m_clientlist);
+		actions = PendingActivate;
+		show_desktop();
 	} else if (index == m_desktop_active) {
-		m_desktoplist[index].show(m_clientlist);
-	 	if (!(client->has_states(State::Ignored))) {
-			client->warp_pointer();
-			client->raise_window();
-		}
+		show_desktop();
 	} else {
 		switch_to_desktop(index);
-	 	if (!(client->has_states(State::Ignored))) {
-			client->warp_pointer();
-			client->raise_window();
-		}
 	}
-	client->set_window_active();
+	set_pending_client(client, actions);
 	panel_update_desktop_list();
 	panel_update_client_list();
 }
 
-bool XScreen::can_manage(Window w, bool query)
-{
-	XWindowAttributes	 wattr;
-
-	if (w == None) return false;
-	if (!XGetWindowAttributes(wm::display, w, &wattr)) return false;
-	if (wattr.override_redirect) return false;
-	if (query && wattr.map_state != IsViewable) return false;
-	return true;
-}
-
 void XScreen::remove_client(XClient *client)
 {
 	if (conf::debug) {
@@ -273,6 +314,9 @@ void XScreen::remove_client(XClient *client)
 	auto it = std::find(m_clientlist.begin(), m_clientlist.end(), client);
 	if (it != m_clientlist.end()) {
 		m_clientlist.erase(it);
+		unindex_client(client);
+		if (client == m_pending_client)
+			set_pending_client(NULL, 0);
 		client->set_removed();
 		delete client;
 	}
@@ -283,11 +327,11 @@ void XScreen::remove_client(XClient *client)
 	update_net_client_lists();
 	if (states & State::Active) {
 		XSetInputFocus(wm::display, PointerRoot, RevertToPointerRoot, CurrentTime);
-		ewmh::set_net_active_window(m_rootwin, None);
+		set_net_active_window(None);
 		panel_clear_title();
 	}
 
-	m_desktoplist[m_desktop_active].show(m_clientlist);
+	show_desktop();
 	panel_update_desktop_list();
 	panel_update_client_list();
 }
@@ -309,13 +353,47 @@ void XScreen::move_client_to_desktop(XClient *client, long index)
 	if ((desktop_index == -1) || (desktop_index == index)) return;
 	client->hide_window();
 	client->assign_to_desktop(index);
-	m_desktoplist[m_desktop_active].show(m_clientlist);
+	show_desktop();
 	panel_update_desktop_list();
+	panel_update_client_list();
 }
 
+// The active desktop is laid out once at the end of the event loop
+// iteration, however many changes were made to it.
 void XScreen::show_desktop()
 {
+	m_layout_pending = true;
+}
+
+void XScreen::update_layout()
+{
+	if (!m_layout_pending) return;
+	m_layout_pending = false;
+	m_state_dirty = true;
 	m_desktoplist[m_desktop_active].show(m_clientlist);
+
+	XClient *client = m_pending_client;
+	long actions = m_pending_actions;
+	if (!client) return;
+	set_pending_client(NULL, 0);
+
+	// The client may have been hidden or moved away since
+	long index = client->get_desktop_index();
+	if (client->has_state(State::Hidden) ||
+		((index != -1) && (index != m_desktop_active)))
+		return;
+	if (actions & PendingWarp)
+		client->warp_pointer();
+	if (actions & PendingRaise)
+		client->raise_window();
+	if (actions & PendingActivate)
+		client->set_window_active();
+}
+
+void XScreen::set_pending_client(XClient *client, long actions)
+{
+	m_pending_client = client;
+	m_pending_actions = actions;
 }
 
 void XScreen::hide_desktop()
@@ -341,25 +419,69 @@ void XScreen::rotate_desktop_layout(long direction)
 	if (conf::debug) {
 		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
 	}
-	m_desktoplist[m_desktop_active].rotate_layout(m_clientlist, direction);
+	m_desktoplist[m_desktop_active].rotate_layout(direction);
 }
 
+// The root window properties are written once per event loop iteration.
 void XScreen::update_net_client_lists()
 {
+	m_client_lists_dirty = true;
+}
+
+void XScreen::set_net_active_window(Window window)
+{
+	m_net_active_window = window;
+	m_state_dirty = true;
+}
+
+// Publish the state in shared memory once per event loop iteration
+void XScreen::update_state_export()
+{
+	if (!m_state_dirty || !m_state_export) return;
+	m_state_dirty = false;
+	m_state_export->update(this);
+}
+
+// Write the root window properties that changed since last written.
+// Windows added at the end of _NET_CLIENT_LIST are appended to it.
+void XScreen::update_root_properties()
+{
+	if (m_net_active_window != m_net_active_written) {
+		ewmh::set_net_active_window(m_rootwin, m_net_active_window);
+		m_net_active_written = m_net_active_window;
+	}
+
+	if (!m_client_lists_dirty) return;
+	m_client_lists_dirty = false;
 	if (conf::debug) {
 		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
 	}
+
 	// _NET_CLIENT_LIST is ordered from oldest to newest
 	std::vector<Window> netclientlist;
 	for (auto it = m_clientlist.rbegin(); it != m_clientlist.rend(); it++)
 		netclientlist.push_back((*it)->get_window());
-	ewmh::set_net_client_list(m_rootwin, netclientlist);
+	size_t n = m_net_client_list.size();
+	if ((n > 0) && (netclientlist.size() > n) &&
+		std::equal(m_net_client_list.begin(), m_net_client_list.end(),
+				netclientlist.begin())) {
+		ewmh::append_net_client_list(m_rootwin, netclientlist, n);
+		m_net_client_list.swap(netclientlist);
+	} else if (!m_client_lists_written ||
+			(netclientlist != m_net_client_list)) {
+		ewmh::set_net_client_list(m_rootwin, netclientlist);
+		m_net_client_list.swap(netclientlist);
+	}
 
 	// _NET_CLIENT_LIST_STACKING use reverse order
 	netclientlist.clear();
 	for (auto it = m_clientlist.begin(); it != m_clientlist.end(); it++)
 		netclientlist.push_back((*it)->get_window());
-	ewmh::set_net_client_list_stacking(m_rootwin, netclientlist);
+	if (!m_client_lists_written || (netclientlist != m_net_client_stacking)) {
+		ewmh::set_net_client_list_stacking(m_rootwin, netclientlist);
+		m_net_client_stacking.swap(netclientlist);
+	}
+	m_client_lists_written = true;
 }
 
 void XScreen::set_net_desktop_names()
@@ -377,74 +499,245 @@ void XScreen::set_net_desktop_names()
 
 void XScreen::panel_clear_title()
 {
-	if (!socket_out::defined()) return;
-	std::string message = "{\"no_active_window\":\"\"}";
-	socket_out::send(message);
+	panel_update_title(None);
+}
+
+// The active window, or None, is sent to the panel after the changes of
+// the desktop and client lists, once per event loop iteration.
+void XScreen::panel_update_title(Window window)
+{
+	m_panel_focus = window;
+	m_panel_focus_dirty = true;
 }
 
 void XScreen::panel_update_desktop_name()
 {
-	if (!socket_out::defined()) return;
-	std::string str = m_desktoplist[m_desktop_active].get_name();
-	str = std::regex_replace(str, std::regex("\\\\"), "\\$&");
-	str = std::regex_replace(str, std::regex("\""), "\\$&");
-	std::string message = "{\"deskname\":\"" + str + "\"}";
-	socket_out::send(message);
+	if (!events::wanted(TopicDesktops)) return;
+	static std::string message;
+	JsonWriter json(message);
+	json.begin_object().key("deskname")
+		.value(m_desktoplist[m_desktop_active].get_name()).end_object();
+	events::publish(TopicDesktops, message);
 }
 
+// The changes of the desktop and client lists are sent to the panel once
+// per event loop iteration, however many changes were made to them.
 void XScreen::panel_update_desktop_list()
 {
-	if (!socket_out::defined()) return;
-	std::stringstream ss;
-	bool first = true;
-	for (int i = 0; i < m_ndesktops; i++) {
-		if (desktop_empty(i) && (i != m_desktop_active))
+	m_panel_desklist_dirty = true;
+	m_state_dirty = true;
+}
+
+void XScreen::panel_update_client_list()
+{
+	m_panel_clientlist_dirty = true;
+	m_state_dirty = true;
+}
+
+void XScreen::update_panel()
+{
+	if (m_panel_desklist_dirty) {
+		m_panel_desklist_dirty = false;
+		send_desktop_states();
+	}
+	if (m_panel_clientlist_dirty) {
+		m_panel_clientlist_dirty = false;
+		send_client_changes();
+	}
+	if (m_panel_focus_dirty) {
+		m_panel_focus_dirty = false;
+		send_focus();
+	}
+}
+
+// Send the title of the active window, or that there is none.
+void XScreen::send_focus()
+{
+	if (m_panel_focus == None) {
+		if (!events::wanted(TopicFocus)) return;
+		std::string message = "{\"no_active_window\":\"\"}";
+		events::publish(TopicFocus, message);
+		return;
+	}
+	XClient *client = find_client(m_panel_focus);
+	if (client && (client->get_screen() == this))
+		client->send_title();
+}
+
+// Send the desktops whose state changed since the last message.
+void XScreen::send_desktop_states()
+{
+	if (!events::wanted(TopicDesktops)) return;
+	static std::string message;
+	count_desktop_clients();
+	m_panel_deskstates.resize(m_ndesktops, NULL);
+	for (long i = 0; i < m_ndesktops; i++) {
+		const char *state = get_desktop_state(i);
+		if (state == m_panel_deskstates[i]) continue;
+		m_panel_deskstates[i] = state;
+		JsonWriter json(message);
+		json.begin_object().key("desktop_state").begin_object()
+			.key("screen").value(m_screenid)
+			.key("desknum").quoted(i+1)
+			.key("state").value(state)
+			.end_object().end_object();
+		events::publish(TopicDesktops, message);
+	}
+}
+
+// Send the clients added, removed, renamed or moved to another desktop
+// since the last message.
+void XScreen::send_client_changes()
+{
+	if (!events::wanted(TopicClients|TopicTitle)) return;
+	static std::string message;
+	unsigned long generation = ++m_panel_generation;
+	for (XClient *client : m_clientlist) {
+		if (client->has_states(State::Ignored)) continue;
+		long desknum = client->get_desktop_index() + 1;
+		auto res = m_panel_clients.try_emplace(client->get_window());
+		PanelClient &pc = res.first->second;
+		pc.generation = generation;
+		if (res.second) {
+			pc.desknum = desknum;
+			pc.name = client->get_name();
+			JsonWriter json(message);
+			json.begin_object().key("client_added").begin_object()
+				.key("screen").value(m_screenid)
+				.key("window").quoted(client->get_window())
+				.key("instance").value(client->get_res_name())
+				.key("desknum").quoted(desknum)
+				.key("name").value(client->get_name())
+				.end_object().end_object();
+			events::publish(TopicClients, message);
 			continue;
-		if (!first) ss << ",";
-		ss << "{\"desknum\":\"" << i+1 << "\",";
-		if (i == m_desktop_active)
-			ss << "\"state\":\"active\"}";
-		else if (desktop_urgent(i))
-			ss << "\"state\":\"urgent\"}";
-		else
-			ss << "\"state\":\"hidden\"}";
-		first = false;
+		}
+		if (pc.desknum != desknum) {
+			pc.desknum = desknum;
+			JsonWriter json(message);
+			json.begin_object().key("client_moved").begin_object()
+				.key("screen").value(m_screenid)
+				.key("window").quoted(client->get_window())
+				.key("desknum").quoted(desknum)
+				.end_object().end_object();
+			events::publish(TopicClients, message);
+		}
+		if (pc.name != client->get_name()) {
+			pc.name = client->get_name();
+			JsonWriter json(message);
+			json.begin_object().key("client_renamed").begin_object()
+				.key("screen").value(m_screenid)
+				.key("window").quoted(client->get_window())
+				.key("name").value(client->get_name())
+				.end_object().end_object();
+			events::publish(TopicTitle, message);
+		}
 	}
-	std::string message = "{\"desklist\":[" + ss.str() + "]}";
-	if (conf::debug>1) {
-		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
-		std::cout << "message = [" << message << "]\n";
+
+	for (auto it = m_panel_clients.begin(); it != m_panel_clients.end(); ) {
+		if (it->second.generation == generation) {
+			it++;
+			continue;
+		}
+		JsonWriter json(message);
+		json.begin_object().key("client_removed").begin_object()
+			.key("screen").value(m_screenid)
+			.key("window").quoted(it->first)
+			.end_object().end_object();
+		events::publish(TopicClients, message);
+		it = m_panel_clients.erase(it);
 	}
-	socket_out::send(message);
 }
 
-void XScreen::panel_update_client_list()
+// Append the complete state of the screen to the snapshot. The following
+// messages are changes relative to it.
+void XScreen::write_snapshot(std::string &messages)
 {
-	if (!socket_out::defined()) return;
-	std::stringstream ss;
-	bool first = true;
+	// Pending changes go to the current receivers before the new baseline
+	update_panel();
+
+	std::string message;
+	JsonWriter json(message);
+	json.begin_object().key("snapshot").begin_object()
+		.key("screen").value(m_screenid)
+		.key("deskname").value(m_desktoplist[m_desktop_active].get_name());
+
+	count_desktop_clients();
+	m_panel_deskstates.resize(m_ndesktops);
+	json.key("desklist").begin_array();
+	for (long i = 0; i < m_ndesktops; i++) {
+		m_panel_deskstates[i] = get_desktop_state(i);
+		json.begin_object()
+			.key("desknum").quoted(i+1)
+			.key("state").value(m_panel_deskstates[i])
+			.end_object();
+	}
+	json.end_array();
+
+	json.key("layouts");
+	m_desktoplist[m_desktop_active].write_layouts(json);
+
+	m_panel_clients.clear();
+	unsigned long generation = ++m_panel_generation;
+	json.key("clientlist").begin_array();
 	for (int i = -1; i < m_ndesktops; i++) {
 		for (XClient *client : m_clientlist) {
 			if (client->has_states(State::Ignored)) continue;
 			long index = client->get_desktop_index();
 			if (index != i) continue;
-			if (!first) ss << ",";
-			ss << "{\"window\":\"" << client->get_window() << "\",";
-			ss << "\"instance\":\"" << client->get_res_name() << "\",";
-			ss << "\"desknum\":\"" << index+1 << "\",";
-			std::string str = client->get_name();
-			str = std::regex_replace(str, std::regex("\\\\"), "\\$&");
-			str = std::regex_replace(str, std::regex("\""), "\\$&");
-			ss << "\"name\":\"" + str + "\"}";
-			first = false;
+			m_panel_clients[client->get_window()] =
+				PanelClient { index+1, client->get_name(), generation };
+			Geometry &g = client->get_geometry();
+			json.begin_object()
+				.key("window").quoted(client->get_window())
+				.key("instance").value(client->get_res_name())
+				.key("desknum").quoted(index+1)
+				.key("name").value(client->get_name())
+				.key("geometry").begin_object()
+				.key("x").value(g.x).key("y").value(g.y)
+				.key("w").value(g.w).key("h").value(g.h)
+				.end_object().end_object();
 		}
 	}
-	std::string message = "{\"clientlist\":[" + ss.str() + "]}";
-	if (conf::debug>1) {
-		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
-		std::cout << "message = [" << message << "]\n";
+	json.end_array();
+
+	json.key("active_window");
+	XClient *active = get_active_client();
+	if (active) {
+		json.begin_object()
+			.key("window").quoted(active->get_window())
+			.key("desknum").quoted(active->get_desktop_index()+1)
+			.key("name").value(active->get_name())
+			.end_object();
+	} else
+		json.null();
+	json.end_object().end_object();
+	messages.append(message).push_back('\n');
+}
+
+// Number of clients and urgency of each desktop, in a single pass
+void XScreen::count_desktop_clients()
+{
+	m_desk_clients.assign(m_ndesktops, 0);
+	m_desk_urgent.assign(m_ndesktops, 0);
+	for (XClient *c : m_clientlist) {
+		long index = c->get_desktop_index();
+		if ((index < 0) || (index >= m_ndesktops)) continue;
+		m_desk_clients[index]++;
+		if (c->has_state(State::Urgent))
+			m_desk_urgent[index] = 1;
 	}
-	socket_out::send(message);
+}
+
+const char *XScreen::get_desktop_state(long index)
+{
+	if (index == m_desktop_active)
+		return "active";
+	if (m_desk_urgent[index])
+		return "urgent";
+	if (m_desk_clients[index])
+		return "hidden";
+	return "empty";
 }
 
 void XScreen::update_geometry()
@@ -490,6 +783,7 @@ void XScreen::update_geometry()
 				continue;
 			}
 			Viewport viewport(i, ci->x, ci->y, ci->width, ci->height, m_bordergap);
+			viewport.set_rate(get_mode_rate(sr, ci->mode));
 			m_viewportlist.push_back(viewport);
 
 			XRRFreeCrtcInfo(ci);
@@ -505,6 +799,21 @@ void XScreen::update_geometry()
 	ewmh::set_net_workarea(m_rootwin, m_ndesktops, m_work);
 }
 
+// Refresh rate of a mode, in Hz
+double XScreen::get_mode_rate(XRRScreenResources *sr, RRMode id)
+{
+	for (int i = 0; i < sr->nmode; i++) {
+		XRRModeInfo &mode = sr->modes[i];
+		if (mode.id != id) continue;
+		double vtotal = mode.vTotal;
+		if (mode.modeFlags & RR_DoubleScan) vtotal *= 2;
+		if (mode.modeFlags & RR_Interlace) vtotal /= 2;
+		if (!mode.hTotal || !vtotal) return 0;
+		return mode.dotClock / (mode.hTotal * vtotal);
+	}
+	return 0;
+}
+
 Geometry XScreen::get_area(Position &p, bool gap)
 {
 	Geometry area = m_view;
@@ -622,7 +931,7 @@ void XScreen::desktop_master_resize(long increment)
 	if (conf::debug) {
 		std::cout << timer::gettime() << " [XScreen:" << __func__ << "]\n";
 	}
-	m_desktoplist[m_desktop_active].master_resize(m_clientlist, increment);
+	m_desktoplist[m_desktop_active].master_resize(increment);
 }
 
 bool XScreen::desktop_empty(long index)
@@ -649,9 +958,9 @@ void XScreen::switch_to_desktop(int index)
 	}
 
 	m_desktoplist[m_desktop_active].hide(m_clientlist);
-	m_desktoplist[index].show(m_clientlist);
 	m_desktop_last = m_desktop_active;
 	m_desktop_active = index;
+	show_desktop();
 	ewmh::set_net_current_desktop(m_rootwin, m_desktop_active);
 	panel_update_desktop_name();
 	panel_update_desktop_list();
@@ -680,35 +989,53 @@ void XScreen::activate_client(long window)
 	else {
 		show_desktop();
 	}
-	client->warp_pointer();
+	set_pending_client(client, PendingWarp);
 }
 
 XClient *XScreen::find_active_client()
 {
-	for (XScreen *screen : wm::screenlist)
-		for (XClient *client : screen->m_clientlist)
-			if (client->has_state(State::Active)) return client;
-	return NULL;
+	return s_active;
 }
 
 XScreen *XScreen::find_screen(Window win)
 {
-	for (XScreen *screen : wm::screenlist) {
-		if (screen->m_rootwin == win) return screen;
-	}
-	return NULL;
+	auto it = s_winmap.find(win);
+	if ((it == s_winmap.end()) || it->second.client) return NULL;
+	return it->second.screen;
 }
 
 XClient *XScreen::find_client(Window win)
 {
-	auto isClient = [win](XClient *c) { return (c->has_window(win)); };
+	if (win == None) return NULL;
+	auto it = s_winmap.find(win);
+	if (it == s_winmap.end()) return NULL;
+	return it->second.client;
+}
 
-	for (XScreen *screen : wm::screenlist) {
-		auto it = std::find_if(screen->m_clientlist.begin(), screen->m_clientlist.end(),
-					isClient);
-		if (it != screen->m_clientlist.end()) {
-			return *it;
-		}
-	}
-	return NULL;
+// Both the client window and its frame are indexed.
+void XScreen::index_client(XClient *client)
+{
+	WinRef ref(client->get_screen(), client);
+	s_winmap[client->get_window()] = ref;
+	if (client->get_parent() != None)
+		s_winmap[client->get_parent()] = ref;
+	if (client->has_state(State::Active))
+		s_active = client;
+}
+
+void XScreen::unindex_client(XClient *client)
+{
+	s_winmap.erase(client->get_window());
+	s_winmap.erase(client->get_parent());
+	if (s_active == client)
+		s_active = NULL;
+}
+
+// Track the client holding the Active state.
+void XScreen::update_active_client(XClient *client, bool active)
+{
+	if (active)
+		s_active = client;
+	else if (s_active == client)
+		s_active = NULL;
 }
@@ -22,19 +22,60 @@
 
 #ifndef _XSCREEN_H_
 #define _XSCREEN_H_
+#include <X11/extensions/Xrandr.h>
 #include <X11/Xft/Xft.h>
 #include <X11/Xlib.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "geometry.h"
 
 class Desktop;
+class StateExport;
+class XWinProp;
 class XClient;
+class XScreen;
+
+// Entry of the window index: a root window has no client.
+struct WinRef {
+	XScreen			*screen;
+	XClient			*client;
+	WinRef(): screen(NULL), client(NULL) {}
+	WinRef(XScreen *s, XClient *c): screen(s), client(c) {}
+};
+
+// Client as last described to the panel
+struct PanelClient {
+	long			 desknum;
+	std::string		 name;
+	unsigned long		 generation;
+};
 
 class XScreen {
 	int			 	 m_screenid;
 	Window			 	 m_rootwin;
 	bool				 m_cycling;
+	bool				 m_layout_pending;
+	XClient				*m_pending_client;
+	long				 m_pending_actions;
+	bool				 m_client_lists_dirty;
+	bool				 m_client_lists_written;
+	std::vector<Window>		 m_net_client_list;
+	std::vector<Window>		 m_net_client_stacking;
+	Window				 m_net_active_window;
+	Window				 m_net_active_written;
+	// State last described to the panel
+	bool				 m_panel_desklist_dirty;
+	bool				 m_panel_clientlist_dirty;
+	bool				 m_panel_focus_dirty;
+	Window				 m_panel_focus;
+	std::vector<const char *>	 m_panel_deskstates;
+	std::vector<long>		 m_desk_clients;
+	std::vector<char>		 m_desk_urgent;
+	StateExport			*m_state_export;
+	bool				 m_state_dirty;
+	std::unordered_map<Window, PanelClient> m_panel_clients;
+	unsigned long			 m_panel_generation;
 	Geometry	 		 m_view; // viewable area
 	Geometry			 m_work; // workable area, gap-applied
 	BorderGap	 		 m_bordergap;
@@ -48,6 +89,9 @@ class XScreen {
 	Colormap			 m_colormap;
 	std::vector<XftColor>		 m_palette;
 	XftFont				*m_propfont;
+	XWinProp			*m_winprop;
+	static std::unordered_map<Window, WinRef> s_winmap;
+	static XClient			*s_active;
 public:
 	XScreen(int);
 	~XScreen();
@@ -59,7 +103,9 @@ public:
 	long			 	 get_last_desktop() const { return m_desktop_last; }
 	std::vector<XClient*> 		&get_clients() { return m_clientlist; }
 	std::vector<Desktop> 		&get_desktops() { return m_desktoplist; }
+	std::vector<Viewport> 		&get_viewports() { return m_viewportlist; }
 	XftFont				*get_prop_font() { return m_propfont; }
+	XWinProp			*get_winprop() { return m_winprop; }
 	long	 		 	 get_num_desktops() const { return m_ndesktops; }
 	Geometry	 		 get_view() const { return m_view; }
 	bool			 	 is_cycling() const { return m_cycling; }
@@ -71,17 +117,24 @@ public:
 	void				 grab_keybindings();
 	XClient				*get_active_client();
 	void 				 add_client(Window);
-	bool  				 can_manage(Window, bool);
 	void 				 remove_client(XClient *);
 	void 				 update_net_client_lists();
+	void 				 set_net_active_window(Window);
+	void 				 update_root_properties();
+	void				 set_state_dirty() { m_state_dirty = true; }
+	void 				 update_state_export();
 	void 				 move_client_to_desktop(XClient *, long);
 	void 				 raise_window(XClient *);
 	void 				 set_net_desktop_names();
 	void 				 panel_clear_title();
+	void 				 panel_update_title(Window);
 	void 				 panel_update_desktop_list();
 	void 				 panel_update_desktop_name();
 	void 				 panel_update_client_list();
+	void 				 update_panel();
+	void 				 write_snapshot(std::string&);
 	void 				 show_desktop();
+	void 				 update_layout();
 	void 				 hide_desktop();
 	void 				 close_desktop();
 	void				 update_geometry();
@@ -100,7 +153,17 @@ public:
 	static XClient			*find_active_client();
 	static XClient			*find_client(Window);
 	static XScreen			*find_screen(Window);
+	static void			 index_client(XClient *);
+	static void			 unindex_client(XClient *);
+	static void			 update_active_client(XClient *, bool);
 private:
 	void 				 add_existing_clients();
+	void 				 set_pending_client(XClient *, long);
+	void				 send_desktop_states();
+	void				 send_client_changes();
+	void				 send_focus();
+	void				 count_desktop_clients();
+	double				 get_mode_rate(XRRScreenResources *, RRMode);
+	const char			*get_desktop_state(long);
 };
 #endif /* _XSCREEN_H_ */
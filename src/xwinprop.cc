@@ -19,23 +19,42 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
-#include <string>
+#include <cstring>
 #include "config.h"
 #include "wmcore.h"
 #include "xscreen.h"
 #include "xwinprop.h"
 
-XWinProp::XWinProp(XScreen *screen, Window parent)
+// Characters of the labels made by XClient::get_drag_label
+static const char *LabelGlyphs = "0123456789 .x-";
+
+XWinProp::XWinProp(XScreen *screen)
 {
-	unsigned long pixel;
 	m_font = screen->get_prop_font();
 	m_color = screen->get_color(Color::PropForeground);
-	pixel = screen->get_pixel(Color::PropBackground);
-	m_window = XCreateSimpleWindow(wm::display, parent, 0, 0, 1, 1, 0,
-					pixel, pixel);
+
+	XSetWindowAttributes attr;
+	attr.override_redirect = True;
+	attr.background_pixel = screen->get_pixel(Color::PropBackground);
+	attr.event_mask = ExposureMask;
+	m_window = XCreateWindow(wm::display, screen->get_window(), 0, 0, 1, 1,
+				0, CopyFromParent, InputOutput, CopyFromParent,
+				CWOverrideRedirect|CWBackPixel|CWEventMask, &attr);
 	m_xftdraw = XftDrawCreate(wm::display, m_window, screen->get_visual(),
 					screen->get_colormap());
-	XMapWindow(wm::display, m_window);
+
+	for (short &advance : m_advances)
+		advance = -1;
+	for (const char *c = LabelGlyphs; *c; c++) {
+		XGlyphInfo extents;
+		XftTextExtentsUtf8(wm::display, m_font, (const FcChar8*)c, 1,
+					&extents);
+		m_advances[(int)*c] = extents.xOff;
+	}
+
+	m_text[0] = '\0';
+	m_x = m_y = m_width = 0;
+	m_mapped = false;
 }
 
 XWinProp::~XWinProp()
@@ -44,16 +63,64 @@ XWinProp::~XWinProp()
 	XDestroyWindow(wm::display, m_window);
 }
 
-void XWinProp::draw(std::string &text, int x, int y)
+// Draw the text centered horizontally on x, below y, in root coordinates.
+void XWinProp::draw(const char *text, int x, int y)
 {
-	XGlyphInfo	extents;
-	int 		len = text.size();
+	bool changed = strcmp(text, m_text);
+	int width = m_width;
+	if (changed) {
+		strncpy(m_text, text, TextSize - 1);
+		m_text[TextSize - 1] = '\0';
+		width = get_width(m_text, strlen(m_text));
+	}
+
+	x -= width/2;
+	if (width != m_width)
+		XMoveResizeWindow(wm::display, m_window, x, y, width, m_font->height);
+	else if ((x != m_x) || (y != m_y))
+		XMoveWindow(wm::display, m_window, x, y);
+	m_x = x;
+	m_y = y;
+	m_width = width;
+
+	if (!m_mapped) {
+		XMapRaised(wm::display, m_window);
+		m_mapped = true;
+	}
+	if (changed) redraw();
+}
 
-	XftTextExtentsUtf8(wm::display, m_font, (const FcChar8*)text.c_str(),
-				len, &extents);
-	XMoveResizeWindow(wm::display, m_window, x - extents.width/2, y,
-				extents.xOff, m_font->height);
+// Paint the current text, also when the label is exposed
+void XWinProp::redraw()
+{
+	if (!m_mapped) return;
 	XClearWindow(wm::display, m_window);
 	XftDrawStringUtf8(m_xftdraw, m_color, m_font, 0, m_font->ascent + 1,
-				(const FcChar8*)text.c_str(), len);
+				(const FcChar8*)m_text, strlen(m_text));
+}
+
+void XWinProp::hide()
+{
+	if (!m_mapped) return;
+	XUnmapWindow(wm::display, m_window);
+	m_mapped = false;
+	m_text[0] = '\0';
+}
+
+// Width of the text from the cached advances. Any other text is measured
+// by the server.
+int XWinProp::get_width(const char *text, int len)
+{
+	int width = 0;
+	for (int i = 0; i < len; i++) {
+		unsigned char c = text[i];
+		if ((c >= NumGlyphs) || (m_advances[c] < 0)) {
+			XGlyphInfo extents;
+			XftTextExtentsUtf8(wm::display, m_font,
+					(const FcChar8*)text, len, &extents);
+			return extents.xOff;
+		}
+		width += m_advances[c];
+	}
+	return width;
 }
@@ -24,16 +24,34 @@
 #define _XWINPROP_H_
 #include <X11/Xlib.h>
 #include <X11/Xft/Xft.h>
-#include <string>
 
+class XScreen;
+
+// Label showing the position or size of a window while it is dragged.
+// There is one per screen, mapped only during the drag. The advances of
+// the glyphs used by the labels are cached, and the label is redrawn
+// only when its text changes or when it is exposed.
 class XWinProp {
+public:
+	static const int	 TextSize = 32;
+private:
+	static const int	 NumGlyphs = 128;
 	Window		 m_window;
 	XftDraw		*m_xftdraw;
 	XftFont		*m_font;
 	XftColor	*m_color;
+	short		 m_advances[NumGlyphs];	// -1 if not cached
+	char		 m_text[TextSize];
+	int		 m_x, m_y, m_width;
+	bool		 m_mapped;
+	int		 get_width(const char *, int);
 public:
-	XWinProp(XScreen *, Window);
+	XWinProp(XScreen *);
+	XWinProp(const XWinProp&) = delete;
 	~XWinProp();
-	void 		draw(std::string &, int, int);
+	Window		 get_window() const { return m_window; }
+	void 		 draw(const char *, int, int);
+	void		 redraw();
+	void		 hide();
 };
 #endif /* _XWINPROP_H_ */
@@ -0,0 +1,128 @@
+// zwm - a minimal stacking/tiling window manager for X11
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/*
+ * Layout of the state region exported by zwm when state-export is enabled.
+ * The region is the file "state-<screen>" in the directory of the command
+ * socket, mapped read-only by the readers. This header is usable from C
+ * and C++.
+ *
+ * The region is written under a seqlock: seq is odd while the writer
+ * updates it. A reader copies the region and retries if seq was odd or
+ * changed during the copy, which zwm_state_copy() does.
+ */
+
+#ifndef _ZWMSTATE_H_
+#define _ZWMSTATE_H_
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ZWM_STATE_MAGIC		0x534d575aU	/* "ZWMS" */
+#define ZWM_STATE_VERSION	1
+#define ZWM_STATE_MAX_DESKTOPS	32
+#define ZWM_STATE_MAX_CLIENTS	1024
+#define ZWM_STATE_STRINGS_SIZE	(128 * 1024)
+
+/* Desktop flags */
+#define ZWM_DESKTOP_ACTIVE	0x01
+#define ZWM_DESKTOP_URGENT	0x02
+#define ZWM_DESKTOP_OCCUPIED	0x04
+
+/* Client states */
+#define ZWM_CLIENT_ACTIVE	0x000001
+#define ZWM_CLIENT_HIDDEN	0x000002
+#define ZWM_CLIENT_STICKY	0x000004
+#define ZWM_CLIENT_URGENT	0x000008
+#define ZWM_CLIENT_FROZEN	0x000010
+#define ZWM_CLIENT_SKIP_PAGER	0x000020
+#define ZWM_CLIENT_SKIP_TASKBAR	0x000040
+#define ZWM_CLIENT_FULLSCREEN	0x000100
+#define ZWM_CLIENT_HMAXIMIZED	0x000200
+#define ZWM_CLIENT_VMAXIMIZED	0x000400
+#define ZWM_CLIENT_TILED	0x000800
+#define ZWM_CLIENT_NOTILE	0x001000
+
+struct zwm_state_client {
+	uint64_t	window;
+	int32_t		desktop;	/* 0 based, -1 if sticky */
+	uint32_t	states;
+	uint32_t	title_offset;	/* in the strings, 0 if empty */
+	uint32_t	title_length;	/* in bytes, without the final NUL */
+};
+
+struct zwm_state {
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	seq;
+	uint32_t	size;		/* of the whole region */
+	int32_t		screen;
+	int32_t		active_desktop;	/* 0 based */
+	uint32_t	ndesktops;
+	uint32_t	nclients;
+	uint64_t	active_window;	/* 0 if none */
+	uint32_t	desktop_flags[ZWM_STATE_MAX_DESKTOPS];
+	uint32_t	truncated;	/* clients or titles did not fit */
+	uint32_t	strings_used;
+	struct zwm_state_client clients[ZWM_STATE_MAX_CLIENTS];
+	char		strings[ZWM_STATE_STRINGS_SIZE];
+};
+
+static inline const char *
+zwm_state_title(const struct zwm_state *s, const struct zwm_state_client *c)
+{
+	return s->strings + c->title_offset;
+}
+
+/*
+ * Copy a consistent state from the mapped region into dst. Return 0 on
+ * success, -1 if the region is not initialized or the writer keeps
+ * updating it.
+ */
+static inline int
+zwm_state_copy(const struct zwm_state *src, struct zwm_state *dst)
+{
+	int tries;
+	for (tries = 0; tries < 1000; tries++) {
+		uint32_t s1 = __atomic_load_n(&src->seq, __ATOMIC_ACQUIRE);
+		if (s1 & 1)
+			continue;
+		/* Only the clients and strings in use are copied */
+		memcpy(dst, src, offsetof(struct zwm_state, clients));
+		if (dst->nclients > ZWM_STATE_MAX_CLIENTS)
+			dst->nclients = ZWM_STATE_MAX_CLIENTS;
+		if (dst->strings_used > ZWM_STATE_STRINGS_SIZE)
+			dst->strings_used = ZWM_STATE_STRINGS_SIZE;
+		memcpy(dst->clients, src->clients,
+		    dst->nclients * sizeof(struct zwm_state_client));
+		memcpy(dst->strings, src->strings, dst->strings_used);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&src->seq, __ATOMIC_RELAXED) != s1)
+			continue;
+		if (dst->magic != ZWM_STATE_MAGIC ||
+		    dst->version != ZWM_STATE_VERSION)
+			return -1;
+		return 0;
+	}
+	return -1;
+}
+#endif /* _ZWMSTATE_H_ */
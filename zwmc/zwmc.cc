@@ -0,0 +1,256 @@
+// zwmc - command line client for the zwm command socket
+//
+// Copyright (c) 2026 cmanv
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Size of the pending output above which stdin is no longer read
+static const size_t	 MaxPending = 65536;
+
+static std::string	 appname("zwmc");
+static std::string	 socket_name;
+static std::string	 watch_topics;
+static bool		 watching = false;
+static int		 errors = 0;
+
+static int	 connect_socket(const std::string &);
+static void	 print_replies(std::string &);
+static void	 usage(int);
+
+int main(int argc, char **argv)
+{
+	static struct option longopts[] = {
+		{ "socket",	required_argument,	NULL,	's' },
+		{ "watch",	optional_argument,	NULL,	'w' },
+		{ "help",	no_argument,		NULL,	'h' },
+		{ NULL,		0,			NULL,	0 }
+	};
+	int	 ch;
+
+	while ((ch = getopt_long(argc, argv, "s:w::h", longopts, NULL)) != -1) {
+		switch (ch) {
+		case 's':
+			socket_name = optarg;
+			break;
+		case 'w':
+			watching = true;
+			if (optarg) watch_topics = optarg;
+			break;
+		case 'h':
+			usage(0);
+			break;
+		default:
+			usage(1);
+		}
+	}
+
+	if (socket_name.empty()) {
+		if (std::getenv("XDG_CACHE_HOME")) {
+			socket_name = std::getenv("XDG_CACHE_HOME");
+		} else if (std::getenv("HOME")) {
+			socket_name = std::getenv("HOME") + std::string("/.cache");
+		} else {
+			std::cerr << appname << ": HOME is not defined in the environment!\n";
+			return 1;
+		}
+		socket_name += "/zwm/socket";
+	}
+
+	// Commands are taken from the arguments, or from stdin if there
+	// are none and no subscription was requested.
+	std::string output;
+	for (int i = optind; i < argc; i++) {
+		if (!*argv[i]) continue;
+		output.append(argv[i]);
+		output.push_back('\n');
+	}
+	bool reading = (optind == argc && !watching);
+	if (watching) {
+		output.append("subscribe");
+		if (!watch_topics.empty()) output.append(" " + watch_topics);
+		output.push_back('\n');
+	}
+
+	int fd = connect_socket(socket_name);
+	if (fd < 0) return 1;
+	signal(SIGPIPE, SIG_IGN);
+	// A large write must not keep the replies from being read
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	// Commands are written as fast as the socket accepts them, without
+	// waiting for the replies. When all commands are sent, the write side
+	// is shut down and the window manager closes the connection once it
+	// has replied to every one of them.
+	std::string input;
+	bool shut = false;
+	for (;;) {
+		if (!reading && !watching && !shut && output.empty()) {
+			shutdown(fd, SHUT_WR);
+			shut = true;
+		}
+
+		struct pollfd pfd[2];
+		nfds_t nfds = 1;
+		pfd[0].fd = fd;
+		pfd[0].events = POLLIN;
+		if (!output.empty()) pfd[0].events |= POLLOUT;
+		if (reading && output.length() < MaxPending) {
+			pfd[1].fd = STDIN_FILENO;
+			pfd[1].events = POLLIN;
+			nfds = 2;
+		}
+		if (poll(pfd, nfds, -1) < 0) {
+			if (errno == EINTR) continue;
+			std::cerr << appname << ": poll: " << std::strerror(errno) << std::endl;
+			return 1;
+		}
+
+		if (nfds == 2 && (pfd[1].revents & (POLLIN|POLLHUP))) {
+			char buffer[4096];
+			ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+			if (n > 0) {
+				output.append(buffer, n);
+			} else if (n == 0 || errno != EINTR) {
+				// Terminate a last command without newline
+				if (!output.empty() && output.back() != '\n')
+					output.push_back('\n');
+				reading = false;
+			}
+		}
+
+		if (pfd[0].revents & POLLOUT) {
+			ssize_t n = write(fd, output.data(), output.length());
+			if (n > 0) {
+				output.erase(0, n);
+			} else if (n < 0 && errno != EINTR && errno != EAGAIN) {
+				std::cerr << appname << ": write: " << std::strerror(errno) << std::endl;
+				return 1;
+			}
+		}
+
+		if (pfd[0].revents & (POLLIN|POLLHUP|POLLERR)) {
+			char buffer[65536];
+			ssize_t n = read(fd, buffer, sizeof(buffer));
+			if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+			if (n <= 0) {
+				if (n < 0)
+					std::cerr << appname << ": read: "
+						<< std::strerror(errno) << std::endl;
+				if (!input.empty()) input.push_back('\n');
+				print_replies(input);
+				std::cout.flush();
+				break;
+			}
+			input.append(buffer, n);
+			print_replies(input);
+			if (watching) std::cout.flush();
+		}
+	}
+	close(fd);
+	return errors ? 1 : 0;
+}
+
+static int connect_socket(const std::string &name)
+{
+	int fd = -1, err = 0;
+
+	size_t pos = name.find(":");
+	if (pos != std::string::npos) {
+		struct addrinfo hint, *result, *ai;
+		memset(&hint, 0, sizeof(hint));
+		hint.ai_family = AF_UNSPEC;
+		hint.ai_socktype = SOCK_STREAM;
+		hint.ai_protocol = IPPROTO_TCP;
+		std::string hostname = name.substr(0, pos);
+		std::string port = name.substr(pos+1);
+		int res = getaddrinfo(hostname.c_str(), port.c_str(), &hint, &result);
+		if (res) {
+			std::cerr << appname << ": " << name << ": " << gai_strerror(res) << "\n";
+			return -1;
+		}
+		for (ai = result; ai; ai = ai->ai_next) {
+			fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+			if (fd < 0) continue;
+			if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+			err = errno;
+			close(fd);
+			fd = -1;
+		}
+		freeaddrinfo(result);
+	} else {
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (name.length() >= sizeof(addr.sun_path)) {
+			std::cerr << appname << ": " << name << ": path too long\n";
+			return -1;
+		}
+		strncpy(addr.sun_path, name.c_str(), sizeof(addr.sun_path) - 1);
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+			err = errno;
+			close(fd);
+			fd = -1;
+		}
+	}
+	if (fd < 0)
+		std::cerr << appname << ": " << name << ": "
+			<< std::strerror(err ? err : errno) << "\n";
+	return fd;
+}
+
+// Print the complete lines received and count the error replies.
+static void print_replies(std::string &input)
+{
+	size_t start = 0, end;
+	while ((end = input.find('\n', start)) != std::string::npos) {
+		std::string_view line(input.data() + start, end - start);
+		if (line.rfind("{\"status\":\"error\"", 0) == 0)
+			errors++;
+		std::cout << line << '\n';
+		start = end + 1;
+	}
+	input.erase(0, start);
+}
+
+static void usage(int rc)
+{
+	std::cerr << "Usage: " << appname << " [-h] [-s socket] [-w[topics]] [command ...]\n";
+	std::cerr << "  -s socket	: Path of command socket.\n";
+	std::cerr << "  -w[topics]	: Subscribe to messages and print them.\n";
+	std::cerr << "  -h 		: Show this help and exit.\n";
+	std::cerr << "Commands are read from stdin if none is given.\n";
+	exit(rc);
+}